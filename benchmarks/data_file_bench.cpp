@@ -0,0 +1,143 @@
+#include "core/DataFile.h"
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTime>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compares save time, load time and file size of the JSON and CBOR encodings on
+// synthetic data shaped like the planner's stores.
+// Usage: data_file_bench [records]
+namespace {
+constexpr int kRuns = 5;
+
+struct Dataset {
+    std::string name;
+    QJsonDocument document;
+};
+
+QJsonObject syntheticEvent(int i) {
+    const QDateTime start(QDate(2025, 10, 27).addDays(i % 600), QTime(8 + i % 8, 0));
+    return QJsonObject{
+        {QStringLiteral("id"), QStringLiteral("6f1c2a3e-0000-4000-8000-%1").arg(i, 12, 10, QLatin1Char('0'))},
+        {QStringLiteral("title"), QStringLiteral("Lesson %1").arg(i)},
+        {QStringLiteral("start"), start.toString(Qt::ISODate)},
+        {QStringLiteral("end"), start.addSecs(45 * 60).toString(Qt::ISODate)},
+        {QStringLiteral("allDay"), false},
+        {QStringLiteral("location"), QStringLiteral("Room %1").arg(i % 40)},
+        {QStringLiteral("notes"), QStringLiteral("Homework and preparation notes for lesson %1. ").repeated(4).arg(i)},
+        {QStringLiteral("tags"), QJsonArray{QStringLiteral("untis")}},
+        {QStringLiteral("isExam"), i % 25 == 0},
+        {QStringLiteral("isDone"), i % 3 == 0},
+        {QStringLiteral("priority"), i % 4},
+        {QStringLiteral("source"), QStringLiteral("untis")},
+        {QStringLiteral("externalId"), QStringLiteral("uid-%1").arg(i)},
+    };
+}
+
+QJsonObject syntheticSession(int i) {
+    const QDateTime start(QDate(2024, 1, 1).addDays(i / 6), QTime(8 + i % 6 * 2, 0));
+    return QJsonObject{
+        {QStringLiteral("start"), start.toString(Qt::ISODate)},
+        {QStringLiteral("end"), start.addSecs(25 * 60).toString(Qt::ISODate)},
+        {QStringLiteral("completed"), i % 5 != 0},
+    };
+}
+
+QJsonObject syntheticReview(int i) {
+    const QDate last = QDate(2025, 1, 1).addDays(i % 365);
+    return QJsonObject{
+        {QStringLiteral("id"), QStringLiteral("review-%1").arg(i)},
+        {QStringLiteral("subjectId"), QStringLiteral("subject-%1").arg(i % 12)},
+        {QStringLiteral("topic"), QStringLiteral("Topic %1").arg(i)},
+        {QStringLiteral("lastReviewDate"), last.toString(Qt::ISODate)},
+        {QStringLiteral("nextReviewDate"), last.addDays(1 + i % 30).toString(Qt::ISODate)},
+        {QStringLiteral("repetitionNumber"), i % 8},
+        {QStringLiteral("easeFactor"), 1.3 + (i % 13) * 0.1},
+        {QStringLiteral("intervalDays"), 1 + i % 30},
+        {QStringLiteral("quality"), i % 6},
+    };
+}
+
+QJsonArray build(int records, const std::function<QJsonObject(int)>& make) {
+    QJsonArray array;
+    for (int i = 0; i < records; ++i) {
+        array.append(make(i));
+    }
+    return array;
+}
+
+double medianMillis(std::vector<qint64> nanos) {
+    std::sort(nanos.begin(), nanos.end());
+    return static_cast<double>(nanos[nanos.size() / 2]) / 1e6;
+}
+
+void run(const QString& dir, const Dataset& dataset, DataFormat format) {
+    data_file::setFormat(format);
+    const QString path = QDir(dir).filePath(QStringLiteral("%1.json").arg(QString::fromStdString(dataset.name)));
+    std::vector<qint64> saves;
+    std::vector<qint64> loads;
+    QElapsedTimer timer;
+    for (int run = 0; run < kRuns; ++run) {
+        timer.start();
+        if (!data_file::write(path, dataset.document)) {
+            std::cerr << "write failed: " << path.toStdString() << '\n';
+            return;
+        }
+        saves.push_back(timer.nsecsElapsed());
+
+        timer.start();
+        const std::optional<QJsonDocument> loaded = data_file::read(path);
+        loads.push_back(timer.nsecsElapsed());
+        if (!loaded) {
+            std::cerr << "read failed: " << path.toStdString() << '\n';
+            return;
+        }
+    }
+    const qint64 bytes = QFileInfo(data_file::storedPath(path)).size();
+    std::cout << "  " << std::left << std::setw(16) << dataset.name << std::setw(6)
+              << data_file::toString(format).toStdString() << std::right << std::fixed << std::setprecision(2)
+              << "  save " << std::setw(9) << medianMillis(saves) << " ms"
+              << "  load " << std::setw(9) << medianMillis(loads) << " ms"
+              << "  size " << std::setw(10) << bytes / 1024 << " KiB\n";
+    data_file::remove(path);
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const int records = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20000;
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::cerr << "No temporary directory\n";
+        return 1;
+    }
+    const std::vector<Dataset> datasets{
+        {"events", QJsonDocument(build(records, syntheticEvent))},
+        {"focus_sessions", QJsonDocument(build(records, syntheticSession))},
+        {"reviews", QJsonDocument(QJsonObject{{QStringLiteral("reviews"), build(records, syntheticReview)}})},
+    };
+
+    std::cout << "=== Data file benchmark (" << records << " records, median of " << kRuns << " runs) ===\n";
+    for (const auto& dataset : datasets) {
+        for (const DataFormat format : {DataFormat::Json, DataFormat::Cbor}) {
+            run(dir.path(), dataset, format);
+        }
+    }
+    return 0;
+}
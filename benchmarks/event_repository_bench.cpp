@@ -0,0 +1,109 @@
+#include "core/EventRepository.h"
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTime>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Micro-benchmark for EventRepository per-operation cost.
+// Usage: event_repository_bench [operations]
+namespace {
+struct Measurement {
+    std::string name;
+    qint64 nanoseconds = 0;
+    int operations = 0;
+};
+
+Measurement measure(const std::string& name, int operations, const std::function<void(int)>& op) {
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < operations; ++i) {
+        op(i);
+    }
+    return {name, timer.nsecsElapsed(), operations};
+}
+
+EventRecord syntheticEvent(int i) {
+    EventRecord record;
+    record.title = QStringLiteral("Lesson %1").arg(i);
+    record.start = QDateTime(QDate(2025, 10, 27).addDays(i % 600), QTime(8 + i % 8, 0));
+    record.end = record.start.addSecs(45 * 60);
+    record.location = QStringLiteral("Room %1").arg(i % 40);
+    record.notes = QStringLiteral("Homework and preparation notes for lesson %1. ").repeated(8).arg(i);
+    record.tags = QStringList{QStringLiteral("untis")};
+    record.source = QStringLiteral("untis");
+    record.externalId = QStringLiteral("uid-%1").arg(i);
+    return record;
+}
+
+QVector<Measurement> runWorkload(bool cacheEnabled, int operations) {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path()) || !repo.isSqlAvailable()) {
+        std::cerr << "SQLite unavailable\n";
+        return {};
+    }
+    repo.setStatementCacheEnabled(cacheEnabled);
+
+    QVector<EventRecord> records;
+    records.reserve(operations);
+    for (int i = 0; i < operations; ++i) {
+        records.append(syntheticEvent(i));
+    }
+
+    QVector<Measurement> results;
+    results.append(measure("insert", operations, [&](int i) { repo.insert(records[i]); }));
+    results.append(measure("update", operations, [&](int i) {
+        records[i].title += QStringLiteral(" *");
+        repo.update(records[i]);
+    }));
+    results.append(measure("setDone", operations, [&](int i) { repo.setDone(records[i].id, true); }));
+    results.append(measure("findByExternalId", operations, [&](int i) {
+        repo.findByExternalId(records[i].source, records[i].externalId);
+    }));
+    Measurement loadFull = measure("loadAll full", 1, [&](int) { repo.loadAll(false, EventProjection::Full); });
+    loadFull.operations = operations;
+    results.append(loadFull);
+    Measurement loadSummary = measure("loadAll summary", 1, [&](int) { repo.loadAll(false, EventProjection::Summary); });
+    loadSummary.operations = operations;
+    results.append(loadSummary);
+    results.append(measure("remove", operations, [&](int i) { repo.remove(records[i].id); }));
+
+    // One transaction for the whole set; reported per item for comparison with insert.
+    for (auto& record : records) {
+        record.id.clear();
+    }
+    Measurement batch = measure("applyBatch insert", 1, [&](int) { repo.applyBatch(records, {}, {}); });
+    batch.operations = operations;
+    results.append(batch);
+    return results;
+}
+
+void printResults(const char* label, const QVector<Measurement>& results) {
+    std::cout << label << '\n';
+    for (const auto& m : results) {
+        const double perOp = m.operations > 0 ? static_cast<double>(m.nanoseconds) / m.operations / 1000.0 : 0.0;
+        std::cout << "  " << std::left << std::setw(18) << m.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << perOp << " us/op\n";
+    }
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const int operations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+
+    std::cout << "=== EventRepository benchmark (" << operations << " ops) ===\n";
+    printResults("Statement cache disabled (re-prepare per call):", runWorkload(false, operations));
+    printResults("Statement cache enabled:", runWorkload(true, operations));
+    return 0;
+}
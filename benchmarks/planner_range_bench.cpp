@@ -0,0 +1,104 @@
+#include "core/PlannerService.h"
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Times planning the whole configured range (config.json "start".."end") day by
+// day on one thread against generateRange(), which plans the days on the global
+// thread pool, and reports the cost of a single generateDay() call. The plan cache
+// is cleared before each cold run; the warm run serves the range from the cache.
+// Usage: planner_range_bench [runs]
+namespace {
+double medianMillis(std::vector<qint64> nanos) {
+    std::sort(nanos.begin(), nanos.end());
+    return static_cast<double>(nanos[nanos.size() / 2]) / 1e6;
+}
+
+bool samePlan(const QList<QVector<Task>>& a, const QList<QVector<Task>>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int day = 0; day < a.size(); ++day) {
+        if (a.at(day).size() != b.at(day).size()) {
+            return false;
+        }
+        for (int i = 0; i < a.at(day).size(); ++i) {
+            const Task& x = a.at(day).at(i);
+            const Task& y = b.at(day).at(i);
+            if (x.id != y.id || x.goal != y.goal || x.durationMinutes != y.durationMinutes || x.done != y.done) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("noah-bench");
+    QCoreApplication::setApplicationName("planner-range-bench");
+    const int runs = argc > 1 ? std::max(1, std::atoi(argv[1])) : 9;
+
+    PlannerService planner;
+    const QJsonObject config = planner.config();
+    const QDate start = QDate::fromString(config.value("start").toString(), Qt::ISODate);
+    const QDate end = QDate::fromString(config.value("end").toString(), Qt::ISODate);
+    if (!start.isValid() || !end.isValid() || start > end) {
+        std::cerr << "config.json has no valid start/end range\n";
+        return 1;
+    }
+
+    std::vector<qint64> serial;
+    std::vector<qint64> parallel;
+    std::vector<qint64> cached;
+    QList<QVector<Task>> serialPlan;
+    QList<QVector<Task>> parallelPlan;
+    QElapsedTimer timer;
+    for (int run = 0; run < runs; ++run) {
+        planner.clearPlanCache();
+        timer.start();
+        serialPlan.clear();
+        for (QDate d = start; d <= end; d = d.addDays(1)) {
+            serialPlan.append(planner.generateDay(d));
+        }
+        serial.push_back(timer.nsecsElapsed());
+
+        planner.clearPlanCache();
+        timer.start();
+        parallelPlan = planner.generateRange(start, end);
+        parallel.push_back(timer.nsecsElapsed());
+
+        timer.start();
+        planner.generateRange(start, end);
+        cached.push_back(timer.nsecsElapsed());
+    }
+
+    const double serialMs = medianMillis(serial);
+    const double parallelMs = medianMillis(parallel);
+    const double cachedMs = medianMillis(cached);
+    const qint64 days = start.daysTo(end) + 1;
+    std::cout << "=== Planner range benchmark (" << start.toString(Qt::ISODate).toStdString() << " .. "
+              << end.toString(Qt::ISODate).toStdString() << ", " << days << " days, "
+              << QThreadPool::globalInstance()->maxThreadCount() << " threads, median of " << runs << " runs) ===\n"
+              << std::fixed << std::setprecision(2)
+              << "  serial generateDay loop " << std::setw(9) << serialMs << " ms  ("
+              << serialMs * 1000.0 / static_cast<double>(days) << " us per day)\n"
+              << "  parallel generateRange  " << std::setw(9) << parallelMs << " ms  (x"
+              << (parallelMs > 0.0 ? serialMs / parallelMs : 0.0) << ")\n"
+              << "  cached generateRange    " << std::setw(9) << cachedMs << " ms\n";
+    if (!samePlan(serialPlan, parallelPlan)) {
+        std::cerr << "Parallel plan differs from the serial plan\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "core/EventRepository.h"
+#include "core/StorageProfile.h"
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QTime>
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Runs the same insert/query workload under each storage profile and reports
+// throughput and per-operation latency.
+// Usage: storage_profile_bench [operations]
+namespace {
+struct Measurement {
+    std::string name;
+    std::vector<qint64> latencies; // nanoseconds per operation
+    qint64 total = 0;
+};
+
+Measurement measure(const std::string& name, int operations, const std::function<void(int)>& op) {
+    Measurement m{name, {}, 0};
+    m.latencies.reserve(static_cast<std::size_t>(operations));
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer timer;
+    for (int i = 0; i < operations; ++i) {
+        timer.start();
+        op(i);
+        m.latencies.push_back(timer.nsecsElapsed());
+    }
+    m.total = total.nsecsElapsed();
+    return m;
+}
+
+double percentileMicros(std::vector<qint64> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return static_cast<double>(values[index]) / 1000.0;
+}
+
+EventRecord syntheticEvent(int i) {
+    EventRecord record;
+    record.title = QStringLiteral("Lesson %1").arg(i);
+    record.start = QDateTime(QDate(2025, 10, 27).addDays(i % 365), QTime(8 + i % 8, 0));
+    record.end = record.start.addSecs(45 * 60);
+    record.location = QStringLiteral("Room %1").arg(i % 40);
+    record.notes = QStringLiteral("Homework and preparation notes for lesson %1. ").repeated(8).arg(i);
+    record.tags = QStringList{QStringLiteral("untis")};
+    return record;
+}
+
+std::vector<Measurement> runWorkload(StorageProfile profile, int operations) {
+    QTemporaryDir dir;
+    EventRepository repo;
+    repo.setProfile(profile);
+    if (!dir.isValid() || !repo.initialize(dir.path()) || !repo.isSqlAvailable()) {
+        std::cerr << "SQLite unavailable\n";
+        return {};
+    }
+
+    std::vector<EventRecord> records;
+    records.reserve(static_cast<std::size_t>(operations));
+    for (int i = 0; i < operations; ++i) {
+        records.push_back(syntheticEvent(i));
+    }
+
+    const QDate first(2025, 10, 27);
+    std::vector<Measurement> results;
+    // One commit per call: this is where synchronous matters.
+    results.push_back(measure("insert", operations, [&](int i) { repo.insert(records[static_cast<std::size_t>(i)]); }));
+    results.push_back(measure("setDone", operations, [&](int i) {
+        repo.setDone(records[static_cast<std::size_t>(i)].id, true);
+    }));
+    results.push_back(measure("loadBetween week", operations, [&](int i) {
+        const QDate start = first.addDays(i % 358);
+        repo.loadBetween(start, start.addDays(6), false, EventProjection::Summary);
+    }));
+    results.push_back(measure("search", std::max(1, operations / 10), [&](int i) {
+        repo.search(QStringLiteral("lesson %1").arg(i), false);
+    }));
+
+    QVector<EventRecord> batch;
+    batch.reserve(operations);
+    for (int i = 0; i < operations; ++i) {
+        batch.append(syntheticEvent(operations + i));
+    }
+    results.push_back(measure("applyBatch", 1, [&](int) { repo.applyBatch(batch, {}, {}); }));
+    return results;
+}
+
+void printResults(StorageProfile profile, const std::vector<Measurement>& results) {
+    std::cout << storage_profile::toString(profile).toStdString() << '\n';
+    for (const auto& m : results) {
+        const double seconds = static_cast<double>(m.total) / 1e9;
+        const double throughput = seconds > 0 ? static_cast<double>(m.latencies.size()) / seconds : 0.0;
+        std::cout << "  " << std::left << std::setw(18) << m.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << throughput << " ops/s" << std::setprecision(2)
+                  << "  p50 " << std::setw(10) << percentileMicros(m.latencies, 0.50) << " us"
+                  << "  p99 " << std::setw(10) << percentileMicros(m.latencies, 0.99) << " us\n";
+    }
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    const int operations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+
+    std::cout << "=== Storage profile benchmark (" << operations << " ops) ===\n";
+    for (const StorageProfile profile : {StorageProfile::Durable, StorageProfile::Balanced, StorageProfile::Fast}) {
+        printResults(profile, runWorkload(profile, operations));
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "AsyncEventRepository.h"
+
+AsyncEventRepository::AsyncEventRepository()
+    : m_repository(std::make_unique<EventRepository>()) {
+    m_clock.start();
+    m_thread.setObjectName(QStringLiteral("planner-storage"));
+    m_context.moveToThread(&m_thread);
+    m_thread.start();
+}
+
+AsyncEventRepository::~AsyncEventRepository() {
+    // The connection has to be closed on the thread that opened it. Queued jobs ahead
+    // of this one still run.
+    QMetaObject::invokeMethod(
+        &m_context,
+        [this]() {
+            delete m_maintenanceTimer;
+            m_maintenanceTimer = nullptr;
+            m_repository.reset();
+        },
+        Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QFuture<bool> AsyncEventRepository::initialize(const QString& storageDir) {
+    return run([storageDir](EventRepository& repo) { return repo.initialize(storageDir); });
+}
+
+QFuture<QVector<EventRecord>> AsyncEventRepository::loadAll(bool onlyOpen, EventProjection projection) {
+    return read([onlyOpen, projection](EventRepository& repo) { return repo.loadAll(onlyOpen, projection); });
+}
+
+QFuture<QVector<EventRecord>> AsyncEventRepository::loadBetween(const QDate& start, const QDate& end, bool onlyOpen,
+                                                                EventProjection projection) {
+    return read([start, end, onlyOpen, projection](EventRepository& repo) {
+        return repo.loadBetween(start, end, onlyOpen, projection);
+    });
+}
+
+QFuture<std::optional<EventRecord>> AsyncEventRepository::findById(const QString& id) {
+    return read([id](EventRepository& repo) { return repo.findById(id); });
+}
+
+QFuture<QVector<EventRecord>> AsyncEventRepository::search(const QString& term, bool onlyOpen) {
+    return read([term, onlyOpen](EventRepository& repo) { return repo.search(term, onlyOpen); });
+}
+
+QFuture<std::optional<EventRecord>> AsyncEventRepository::insert(const EventRecord& record) {
+    return run([record](EventRepository& repo) mutable -> std::optional<EventRecord> {
+        if (!repo.insert(record)) {
+            return std::nullopt;
+        }
+        return record;
+    });
+}
+
+QFuture<bool> AsyncEventRepository::update(const EventRecord& record) {
+    return run([record](EventRepository& repo) { return repo.update(record); });
+}
+
+QFuture<bool> AsyncEventRepository::setDone(const QString& id, bool done) {
+    return run([id, done](EventRepository& repo) { return repo.setDone(id, done); });
+}
+
+QFuture<bool> AsyncEventRepository::remove(const QString& id) {
+    return run([id](EventRepository& repo) { return repo.remove(id); });
+}
+
+void AsyncEventRepository::startMaintenance(std::chrono::milliseconds interval, std::chrono::milliseconds idleFor,
+                                            const MaintenancePolicy& policy) {
+    QMetaObject::invokeMethod(
+        &m_context,
+        [this, interval, idleFor, policy]() {
+            if (!m_maintenanceTimer) {
+                m_maintenanceTimer = new QTimer(&m_context);
+            }
+            m_maintenanceTimer->disconnect();
+            m_maintenanceTimer->setInterval(interval);
+            QObject::connect(m_maintenanceTimer, &QTimer::timeout, &m_context, [this, idleFor, policy]() {
+                const qint64 lastActivity = m_lastActivityMs;
+                const bool idle = m_pendingJobs == 0 && m_clock.elapsed() - lastActivity >= idleFor.count();
+                if (idle && lastActivity > m_lastMaintenanceMs) {
+                    m_repository->runMaintenance(policy);
+                    m_lastMaintenanceMs = m_clock.elapsed();
+                }
+            });
+            m_maintenanceTimer->start();
+        },
+        Qt::QueuedConnection);
+}
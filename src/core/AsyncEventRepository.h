@@ -0,0 +1,112 @@
+#pragma once
+
+#include "EventRepository.h"
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QMetaObject>
+#include <QObject>
+#include <QPromise>
+#include <QThread>
+#include <QTimer>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Runs an EventRepository on a dedicated storage thread. The repository, and with it
+// the SQLite connection, is only ever touched from that thread; callers queue jobs
+// and get a QFuture back. Jobs run one at a time in submission order, so a read
+// queued after a write sees its result. Use QFuture::then(context, ...) to handle
+// results on the caller's thread.
+class AsyncEventRepository {
+public:
+    AsyncEventRepository();
+    ~AsyncEventRepository();
+
+    AsyncEventRepository(const AsyncEventRepository&) = delete;
+    AsyncEventRepository& operator=(const AsyncEventRepository&) = delete;
+
+    // Queues an arbitrary job; use for writes and read-modify-write sequences that
+    // must not interleave with other requests.
+    template <typename Job>
+    auto run(Job job) -> QFuture<std::invoke_result_t<Job&, EventRepository&>>;
+    // Same queue as run(), for jobs that only read. They do not count as activity for
+    // startMaintenance(), so periodic polling does not hold maintenance off.
+    template <typename Job>
+    auto read(Job job) -> QFuture<std::invoke_result_t<Job&, EventRepository&>>;
+
+    QFuture<bool> initialize(const QString& storageDir);
+    QFuture<QVector<EventRecord>> loadAll(bool onlyOpen, EventProjection projection = EventProjection::Full);
+    QFuture<QVector<EventRecord>> loadBetween(const QDate& start, const QDate& end, bool onlyOpen,
+                                              EventProjection projection = EventProjection::Full);
+    QFuture<std::optional<EventRecord>> findById(const QString& id);
+    QFuture<QVector<EventRecord>> search(const QString& term, bool onlyOpen);
+
+    // Resolves with the stored record (including its generated id), or nullopt.
+    QFuture<std::optional<EventRecord>> insert(const EventRecord& record);
+    QFuture<bool> update(const EventRecord& record);
+    QFuture<bool> setDone(const QString& id, bool done);
+    QFuture<bool> remove(const QString& id);
+
+    // Runs EventRepository::runMaintenance() on the storage thread once run() jobs have
+    // written since the last pass, none has finished for idleFor and no job is queued,
+    // checking every interval. Maintenance runs between jobs, never interleaved with them.
+    void startMaintenance(std::chrono::milliseconds interval, std::chrono::milliseconds idleFor,
+                          const MaintenancePolicy& policy = MaintenancePolicy());
+
+    QThread* thread() { return &m_thread; }
+
+private:
+    template <typename Job>
+    auto enqueue(Job job, bool countsAsActivity) -> QFuture<std::invoke_result_t<Job&, EventRepository&>>;
+
+    QThread m_thread;
+    QObject m_context;
+    std::unique_ptr<EventRepository> m_repository;
+    QTimer* m_maintenanceTimer = nullptr; // lives on the storage thread
+    qint64 m_lastMaintenanceMs = -1;      // storage thread only
+    QElapsedTimer m_clock;
+    std::atomic<int> m_pendingJobs{0};
+    std::atomic<qint64> m_lastActivityMs{0}; // last finished run() job
+};
+
+template <typename Job>
+auto AsyncEventRepository::run(Job job) -> QFuture<std::invoke_result_t<Job&, EventRepository&>> {
+    return enqueue(std::move(job), true);
+}
+
+template <typename Job>
+auto AsyncEventRepository::read(Job job) -> QFuture<std::invoke_result_t<Job&, EventRepository&>> {
+    return enqueue(std::move(job), false);
+}
+
+template <typename Job>
+auto AsyncEventRepository::enqueue(Job job, bool countsAsActivity)
+    -> QFuture<std::invoke_result_t<Job&, EventRepository&>> {
+    using Result = std::invoke_result_t<Job&, EventRepository&>;
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+    EventRepository* repository = m_repository.get();
+    ++m_pendingJobs;
+    QMetaObject::invokeMethod(
+        &m_context,
+        [this, promise, repository, job, countsAsActivity]() mutable {
+            if constexpr (std::is_void_v<Result>) {
+                job(*repository);
+            } else {
+                promise->addResult(job(*repository));
+            }
+            promise->finish();
+            if (countsAsActivity) {
+                m_lastActivityMs = m_clock.elapsed();
+            }
+            --m_pendingJobs;
+        },
+        Qt::QueuedConnection);
+    return future;
+}
@@ -1,4 +1,5 @@
 #include "CategoryRepository.h"
+#include "DataFile.h"
 
 #include <QDir>
 #include <QFile>
@@ -22,9 +23,9 @@ bool CategoryRepository::initialize(const QString& storageDir) {
     
     m_jsonPath = dir.filePath(QStringLiteral("categories.json"));
     
-    if (!QFile::exists(m_jsonPath)) {
+    if (!data_file::exists(m_jsonPath)) {
         m_categories = defaultCategories();
-        if (!saveToFile()) {
+        if (!saveDefaults()) {
             qWarning() << "[CategoryRepository] Failed to save default categories";
             return false;
         }
@@ -35,7 +36,7 @@ bool CategoryRepository::initialize(const QString& storageDir) {
         }
         if (m_categories.isEmpty()) {
             m_categories = defaultCategories();
-            if (!saveToFile()) {
+            if (!saveDefaults()) {
                 qWarning() << "[CategoryRepository] Failed to re-save default categories";
                 return false;
             }
@@ -49,9 +50,9 @@ QVector<Category> CategoryRepository::loadAll() const {
     return m_categories;
 }
 
-bool CategoryRepository::save(const QVector<Category>& categories) {
+void CategoryRepository::save(const QVector<Category>& categories) {
     m_categories = categories;
-    return saveToFile();
+    saveToFile();
 }
 
 Category CategoryRepository::findById(const QString& id) const {
@@ -75,7 +76,8 @@ bool CategoryRepository::insert(const Category& category) {
     }
     
     m_categories.append(category);
-    return saveToFile();
+    saveToFile();
+    return true;
 }
 
 bool CategoryRepository::update(const Category& category) {
@@ -86,7 +88,8 @@ bool CategoryRepository::update(const Category& category) {
     for (int i = 0; i < m_categories.size(); ++i) {
         if (m_categories[i].id == category.id) {
             m_categories[i] = category;
-            return saveToFile();
+            saveToFile();
+            return true;
         }
     }
     
@@ -98,7 +101,8 @@ bool CategoryRepository::remove(const QString& id) {
     for (int i = 0; i < m_categories.size(); ++i) {
         if (m_categories[i].id == id) {
             m_categories.removeAt(i);
-            return saveToFile();
+            saveToFile();
+            return true;
         }
     }
     
@@ -107,37 +111,29 @@ bool CategoryRepository::remove(const QString& id) {
 }
 
 bool CategoryRepository::loadFromFile() {
-    QFile file(m_jsonPath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "[CategoryRepository] Failed to open file for reading:" << m_jsonPath;
+    const std::optional<QJsonDocument> doc = data_file::read(m_jsonPath);
+    if (!doc) {
+        qWarning() << "[CategoryRepository] Failed to read file:" << m_jsonPath;
         return false;
     }
-    
-    QByteArray data = file.readAll();
-    file.close();
-    
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isArray()) {
+    if (!doc->isArray()) {
         qWarning() << "[CategoryRepository] JSON is not an array";
         return false;
     }
     
-    fromJsonArray(doc.array());
+    fromJsonArray(doc->array());
     return true;
 }
 
-bool CategoryRepository::saveToFile() {
-    QFile file(m_jsonPath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "[CategoryRepository] Failed to open file for writing:" << m_jsonPath;
-        return false;
-    }
-    
-    QJsonDocument doc(toJsonArray());
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
-    
-    return true;
+void CategoryRepository::saveToFile() {
+    // Written by the shared write-behind queue; failures are logged there.
+    data_file::writeLater(m_jsonPath, QJsonDocument(toJsonArray()));
+}
+
+bool CategoryRepository::saveDefaults() {
+    // Written right away rather than behind: initialize() reports whether the store
+    // is usable, which a queued write cannot tell yet.
+    return data_file::write(m_jsonPath, QJsonDocument(toJsonArray()));
 }
 
 QJsonArray CategoryRepository::toJsonArray() const {
@@ -13,7 +13,9 @@ public:
     bool initialize(const QString& storageDir);
     
     QVector<Category> loadAll() const;
-    bool save(const QVector<Category>& categories);
+    // Changes are saved through the data_file write-behind queue, so the bool
+    // results below only report invalid input, duplicates and unknown ids.
+    void save(const QVector<Category>& categories);
     
     Category findById(const QString& id) const;
     bool insert(const Category& category);
@@ -27,7 +29,8 @@ private:
     QVector<Category> m_categories;
     
     bool loadFromFile();
-    bool saveToFile();
+    void saveToFile();
+    bool saveDefaults();
     QJsonArray toJsonArray() const;
     void fromJsonArray(const QJsonArray& array);
     static QVector<Category> defaultCategories();
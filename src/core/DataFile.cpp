@@ -0,0 +1,368 @@
+#include "DataFile.h"
+
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+
+namespace {
+constexpr char kMagic[4] = {'N', 'P', 'C', 'B'};
+constexpr int kHeaderSize = 8;
+
+// -1 until setFormat() is called; the environment is consulted otherwise.
+std::atomic<int> g_format{-1};
+
+std::optional<QJsonDocument> decodeCbor(const QByteArray& data, const QString& path) {
+    if (data.size() < kHeaderSize || !data.startsWith(QByteArray(kMagic, sizeof(kMagic)))) {
+        qWarning() << "[DataFile] Not a planner CBOR file:" << path;
+        return std::nullopt;
+    }
+    const quint32 version = qFromBigEndian<quint32>(data.constData() + sizeof(kMagic));
+    if (version != data_file::kCborVersion) {
+        qWarning() << "[DataFile] Unsupported CBOR format version" << version << "in" << path;
+        return std::nullopt;
+    }
+    QCborStreamReader reader(QByteArray::fromRawData(data.constData() + kHeaderSize, data.size() - kHeaderSize));
+    const QCborValue value = QCborValue::fromCbor(reader);
+    if (reader.lastError() != QCborError::NoError) {
+        qWarning() << "[DataFile] Failed to decode" << path << reader.lastError().toString();
+        return std::nullopt;
+    }
+    if (value.isArray()) {
+        return QJsonDocument(value.toArray().toJsonArray());
+    }
+    if (value.isMap()) {
+        return QJsonDocument(value.toMap().toJsonObject());
+    }
+    qWarning() << "[DataFile] Unexpected CBOR document in" << path;
+    return std::nullopt;
+}
+
+std::optional<QJsonDocument> decodeJson(const QByteArray& data, const QString& path) {
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(data, &error);
+    if (document.isNull()) {
+        qWarning() << "[DataFile] Failed to parse JSON from" << path << error.errorString();
+        return std::nullopt;
+    }
+    return document;
+}
+
+std::optional<QByteArray> readBytes(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[DataFile] Failed to open file for reading:" << path << file.errorString();
+        return std::nullopt;
+    }
+    return file.readAll();
+}
+
+bool writeDocument(const QString& path, const QJsonDocument& document, DataFormat format,
+                   QJsonDocument::JsonFormat jsonFormat) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[DataFile] Failed to open file for writing:" << path << file.errorString();
+        return false;
+    }
+    if (format == DataFormat::Cbor) {
+        char header[kHeaderSize];
+        std::copy(std::begin(kMagic), std::end(kMagic), header);
+        qToBigEndian<quint32>(data_file::kCborVersion, header + sizeof(kMagic));
+        file.write(header, kHeaderSize);
+        QCborStreamWriter writer(&file);
+        const QCborValue value = document.isArray() ? QCborValue(QCborArray::fromJsonArray(document.array()))
+                                                    : QCborValue(QCborMap::fromJsonObject(document.object()));
+        value.toCbor(writer);
+    } else {
+        file.write(document.toJson(jsonFormat));
+    }
+    if (!file.commit()) {
+        qWarning() << "[DataFile] Failed to write" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool store(const QString& jsonPath, const QJsonDocument& document, DataFormat format,
+           QJsonDocument::JsonFormat jsonFormat) {
+    const QString target = format == DataFormat::Cbor ? data_file::cborPath(jsonPath) : jsonPath;
+    const QString other = format == DataFormat::Cbor ? jsonPath : data_file::cborPath(jsonPath);
+    if (!writeDocument(target, document, format, jsonFormat)) {
+        return false;
+    }
+    // The stale twin goes only after the new file is in place; until then reads
+    // still find a complete copy.
+    if (QFileInfo::exists(other) && !QFile::remove(other)) {
+        qWarning() << "[DataFile] Failed to remove" << other;
+    }
+    return true;
+}
+
+// Shared write-behind queue. Pending documents stay visible to read() until they
+// are on disk; m_writeMutex keeps a flush and a direct write to the same file from
+// overtaking each other.
+class WriteBehind {
+public:
+    static WriteBehind& instance() {
+        static WriteBehind writer;
+        return writer;
+    }
+
+    ~WriteBehind() {
+        m_thread.quit();
+        m_thread.wait();
+        flush();
+    }
+
+    void schedule(const QString& jsonPath, const QJsonDocument& document, DataFormat format,
+                  QJsonDocument::JsonFormat jsonFormat) {
+        quint64 arm = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_pending.insert(jsonPath, {document, format, jsonFormat, ++m_generation});
+            if (!m_armed) {
+                m_armed = true;
+                arm = ++m_armGeneration;
+            }
+            if (!m_thread.isRunning()) {
+                m_thread.start();
+                if (QCoreApplication* app = QCoreApplication::instance()) {
+                    QObject::connect(app, &QCoreApplication::aboutToQuit, &m_context, [this]() { flush(); },
+                                     Qt::DirectConnection);
+                }
+            }
+        }
+        if (arm) {
+            const int delay = m_delayMs.load();
+            QMetaObject::invokeMethod(&m_context, [this, delay, arm]() {
+                QTimer::singleShot(delay, &m_context, [this, arm]() {
+                    {
+                        // A flushPending() in the meantime already wrote this burst.
+                        QMutexLocker locker(&m_mutex);
+                        if (!m_armed || m_armGeneration != arm) {
+                            return;
+                        }
+                    }
+                    flush();
+                });
+            });
+        }
+    }
+
+    bool writeNow(const QString& jsonPath, const QJsonDocument& document, DataFormat format,
+                  QJsonDocument::JsonFormat jsonFormat) {
+        QMutexLocker writing(&m_writeMutex);
+        {
+            QMutexLocker locker(&m_mutex);
+            m_pending.remove(jsonPath);
+        }
+        return store(jsonPath, document, format, jsonFormat);
+    }
+
+    std::optional<QJsonDocument> pending(const QString& jsonPath) const {
+        QMutexLocker locker(&m_mutex);
+        const auto it = m_pending.constFind(jsonPath);
+        if (it == m_pending.constEnd()) {
+            return std::nullopt;
+        }
+        return it->document;
+    }
+
+    void cancel(const QString& jsonPath) {
+        QMutexLocker writing(&m_writeMutex);
+        QMutexLocker locker(&m_mutex);
+        m_pending.remove(jsonPath);
+    }
+
+    void flush() {
+        QMutexLocker writing(&m_writeMutex);
+        QHash<QString, Pending> batch;
+        {
+            QMutexLocker locker(&m_mutex);
+            batch = m_pending;
+            m_armed = false;
+        }
+        for (auto it = batch.cbegin(); it != batch.cend(); ++it) {
+            if (!store(it.key(), it->document, it->format, it->jsonFormat)) {
+                qWarning() << "[DataFile] Deferred write failed, keeping it pending:" << it.key();
+                continue;
+            }
+            // Drop the entry unless a newer document arrived while writing.
+            QMutexLocker locker(&m_mutex);
+            const auto current = m_pending.constFind(it.key());
+            if (current != m_pending.constEnd() && current->generation == it->generation) {
+                m_pending.remove(it.key());
+            }
+        }
+    }
+
+    int pendingCount() const {
+        QMutexLocker locker(&m_mutex);
+        return static_cast<int>(m_pending.size());
+    }
+
+    int delay() const { return m_delayMs.load(); }
+    void setDelay(int milliseconds) { m_delayMs.store(std::max(0, milliseconds)); }
+
+private:
+    struct Pending {
+        QJsonDocument document;
+        DataFormat format = DataFormat::Json;
+        QJsonDocument::JsonFormat jsonFormat = QJsonDocument::Indented;
+        quint64 generation = 0;
+    };
+
+    WriteBehind() {
+        m_thread.setObjectName(QStringLiteral("planner-write-behind"));
+        m_context.moveToThread(&m_thread);
+    }
+
+    QThread m_thread;
+    QObject m_context;
+    mutable QMutex m_mutex;
+    QMutex m_writeMutex;
+    QHash<QString, Pending> m_pending;
+    quint64 m_generation = 0;
+    quint64 m_armGeneration = 0;
+    bool m_armed = false;
+    std::atomic<int> m_delayMs{500};
+};
+} // namespace
+
+namespace data_file {
+
+std::optional<DataFormat> fromString(const QString& name) {
+    const QString key = name.trimmed().toLower();
+    if (key == QLatin1String("json")) {
+        return DataFormat::Json;
+    }
+    if (key == QLatin1String("cbor")) {
+        return DataFormat::Cbor;
+    }
+    return std::nullopt;
+}
+
+QString toString(DataFormat format) {
+    return format == DataFormat::Cbor ? QStringLiteral("cbor") : QStringLiteral("json");
+}
+
+DataFormat format() {
+    const int chosen = g_format.load();
+    if (chosen >= 0) {
+        return static_cast<DataFormat>(chosen);
+    }
+    const QString fromEnv = qEnvironmentVariable(kEnvironmentVariable);
+    if (fromEnv.isEmpty()) {
+        return DataFormat::Json;
+    }
+    if (const std::optional<DataFormat> parsed = fromString(fromEnv)) {
+        return *parsed;
+    }
+    qWarning() << "[DataFile] Unknown data format" << fromEnv << "- using json";
+    return DataFormat::Json;
+}
+
+void setFormat(DataFormat format) {
+    g_format.store(static_cast<int>(format));
+}
+
+QString cborPath(const QString& jsonPath) {
+    QString path = jsonPath;
+    if (path.endsWith(QLatin1String(".json"))) {
+        path.chop(5);
+    }
+    return path + QStringLiteral(".cbor");
+}
+
+QString storedPath(const QString& jsonPath) {
+    const QString binary = cborPath(jsonPath);
+    return QFileInfo::exists(binary) ? binary : jsonPath;
+}
+
+bool exists(const QString& jsonPath) {
+    return QFileInfo::exists(jsonPath) || QFileInfo::exists(cborPath(jsonPath))
+        || WriteBehind::instance().pending(jsonPath).has_value();
+}
+
+std::optional<QJsonDocument> read(const QString& jsonPath) {
+    if (std::optional<QJsonDocument> pending = WriteBehind::instance().pending(jsonPath)) {
+        return pending;
+    }
+    const QString binary = cborPath(jsonPath);
+    std::optional<QJsonDocument> document;
+    DataFormat found = DataFormat::Json;
+    if (QFileInfo::exists(binary)) {
+        if (const std::optional<QByteArray> data = readBytes(binary)) {
+            document = decodeCbor(*data, binary);
+            found = DataFormat::Cbor;
+        }
+    }
+    if (!document && QFileInfo::exists(jsonPath)) {
+        if (const std::optional<QByteArray> data = readBytes(jsonPath)) {
+            document = decodeJson(*data, jsonPath);
+            found = DataFormat::Json;
+        }
+    }
+    if (!document) {
+        return std::nullopt;
+    }
+
+    const DataFormat wanted = format();
+    if (found != wanted) {
+        qInfo() << "[DataFile] Converting" << jsonPath << "to" << toString(wanted);
+        write(jsonPath, *document);
+    }
+    return document;
+}
+
+bool write(const QString& jsonPath, const QJsonDocument& document, QJsonDocument::JsonFormat jsonFormat) {
+    return WriteBehind::instance().writeNow(jsonPath, document, format(), jsonFormat);
+}
+
+bool remove(const QString& jsonPath) {
+    WriteBehind::instance().cancel(jsonPath);
+    bool removed = true;
+    for (const QString& path : {jsonPath, cborPath(jsonPath)}) {
+        if (QFileInfo::exists(path) && !QFile::remove(path)) {
+            qWarning() << "[DataFile] Failed to remove" << path;
+            removed = false;
+        }
+    }
+    return removed;
+}
+
+void writeLater(const QString& jsonPath, const QJsonDocument& document, QJsonDocument::JsonFormat jsonFormat) {
+    WriteBehind::instance().schedule(jsonPath, document, format(), jsonFormat);
+}
+
+void flushPending() {
+    WriteBehind::instance().flush();
+}
+
+int pendingCount() {
+    return WriteBehind::instance().pendingCount();
+}
+
+int writeDelay() {
+    return WriteBehind::instance().delay();
+}
+
+void setWriteDelay(int milliseconds) {
+    WriteBehind::instance().setDelay(milliseconds);
+}
+
+} // namespace data_file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QJsonDocument>
+#include <QString>
+
+#include <optional>
+
+// On-disk encoding of the JSON data files (events.json snapshot, categories.json,
+// focus_sessions.json, reviews.json, exams.json, done.json and the other planner
+// seeds). Callers always name the .json path; with the binary format the document
+// is stored next to it as <name>.cbor instead:
+//   "NPCB" magic, 32-bit big-endian format version, then the document as CBOR.
+// CBOR keeps the JSON data model but needs no text parsing or escaping on load
+// and is usually smaller than indented JSON.
+//
+// Reading picks whichever twin exists (the .cbor one first). When the file found
+// is not in the selected format it is rewritten in that format and the other twin
+// removed, so existing data migrates on first use in either direction.
+enum class DataFormat {
+    Json,
+    Cbor
+};
+
+namespace data_file {
+
+constexpr const char* kEnvironmentVariable = "NOAH_PLANNER_DATA_FORMAT";
+constexpr quint32 kCborVersion = 1;
+
+std::optional<DataFormat> fromString(const QString& name);
+QString toString(DataFormat format);
+
+// Format used for writes: setFormat() if called, otherwise NOAH_PLANNER_DATA_FORMAT
+// ("json" or "cbor"), otherwise JSON.
+DataFormat format();
+void setFormat(DataFormat format);
+
+QString cborPath(const QString& jsonPath);
+// The twin that currently holds the data, or jsonPath if neither exists.
+QString storedPath(const QString& jsonPath);
+bool exists(const QString& jsonPath);
+
+// nullopt if no twin exists or the stored one cannot be decoded. A document still
+// waiting in the write-behind queue is returned as is.
+std::optional<QJsonDocument> read(const QString& jsonPath);
+// Writes in format() through QSaveFile (temp file + rename, so readers never see a
+// torn file) and removes the other twin. Replaces a pending writeLater() for the
+// same file. jsonFormat only applies to the text encoding.
+bool write(const QString& jsonPath, const QJsonDocument& document,
+           QJsonDocument::JsonFormat jsonFormat = QJsonDocument::Indented);
+// Removes both twins and drops a pending write.
+bool remove(const QString& jsonPath);
+
+// Write-behind for stores that save their whole state on every change. The
+// document replaces any pending one for the same file; a shared worker thread
+// writes it as write() would, writeDelay() ms after the first change of a burst,
+// so rapid edits cost one write. flushPending() writes everything now on the
+// calling thread; it also runs when QCoreApplication quits and at process exit.
+void writeLater(const QString& jsonPath, const QJsonDocument& document,
+                QJsonDocument::JsonFormat jsonFormat = QJsonDocument::Indented);
+void flushPending();
+int pendingCount();
+int writeDelay();
+void setWriteDelay(int milliseconds);
+
+} // namespace data_file
@@ -1,22 +1,120 @@
 #include "EventRepository.h"
+#include "DataFile.h"
+#include "EventSchema.h"
 
 #include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QHash>
 #include <QJsonValue>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
+#include <QTimeZone>
 #include <QUuid>
 
 #include <algorithm>
+#include <memory>
 #include <optional>
+#include <utility>
 
 #include "PriorityRules.h"
 
 namespace {
+// Change log entries kept at startup and by maintenance; readers further behind
+// reload everything.
+constexpr qint64 kChangeLogRetention = 10000;
+constexpr int kMaintenanceLogRetention = 100;
+// The JSON journal is folded into the snapshot once it is larger than the snapshot
+// and at least this size.
+constexpr qint64 kJournalCompactMinBytes = 256 * 1024;
+
+// Single-value PRAGMA read, or -1 on failure.
+qint64 pragmaValue(const QSqlDatabase& db, const QString& name) {
+    QSqlQuery query(db);
+    if (!query.exec(QStringLiteral("PRAGMA %1").arg(name)) || !query.next()) {
+        qWarning() << "[EventRepository] PRAGMA" << name << "failed" << query.lastError();
+        return -1;
+    }
+    return query.value(0).toLongLong();
+}
+
+// Runs a statement to completion; PRAGMAs such as incremental_vacuum only do their
+// work while rows are being stepped.
+bool execToEnd(const QSqlDatabase& db, const QString& sql) {
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        qWarning() << "[EventRepository]" << sql << "failed" << query.lastError();
+        return false;
+    }
+    while (query.next()) {
+    }
+    return true;
+}
+
+QString externalKey(const QString& source, const QString& externalId) {
+    return source + QChar(0x1f) + externalId;
+}
+
+// Sort key of the JSON cache; events without a start come first, as in loadAll().
+qint64 startKey(const QDateTime& start) {
+    return start.isValid() ? start.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+}
+
+// Applies one journal entry to the replayed array. Removed slots become null and are
+// dropped once the whole journal has been read.
+void applyJournalEntry(QJsonArray& array, QHash<QString, int>& indexById, const QJsonObject& entry) {
+    const QString op = entry.value(QStringLiteral("op")).toString();
+    if (op == QLatin1String("batch")) {
+        const QJsonArray ops = entry.value(QStringLiteral("ops")).toArray();
+        for (const auto& nested : ops) {
+            applyJournalEntry(array, indexById, nested.toObject());
+        }
+    } else if (op == QLatin1String("put")) {
+        const QJsonObject record = entry.value(QStringLiteral("record")).toObject();
+        const QString id = record.value(QStringLiteral("id")).toString();
+        const auto it = indexById.constFind(id);
+        if (it != indexById.constEnd()) {
+            array.replace(it.value(), record);
+        } else {
+            indexById.insert(id, array.size());
+            array.append(record);
+        }
+    } else if (op == QLatin1String("done")) {
+        const auto it = indexById.constFind(entry.value(QStringLiteral("id")).toString());
+        if (it != indexById.constEnd()) {
+            QJsonObject record = array.at(it.value()).toObject();
+            record.insert(QStringLiteral("isDone"), entry.value(QStringLiteral("isDone")).toBool());
+            array.replace(it.value(), record);
+        }
+    } else if (op == QLatin1String("remove")) {
+        const auto it = indexById.find(entry.value(QStringLiteral("id")).toString());
+        if (it != indexById.end()) {
+            array.replace(it.value(), QJsonValue());
+            indexById.erase(it);
+        }
+    } else if (op == QLatin1String("removeSource")) {
+        const QString source = entry.value(QStringLiteral("source")).toString();
+        for (auto it = indexById.begin(); it != indexById.end();) {
+            if (array.at(it.value()).toObject().value(QStringLiteral("source")).toString() == source) {
+                array.replace(it.value(), QJsonValue());
+                it = indexById.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    } else {
+        qWarning() << "[EventRepository] Unknown journal operation" << op;
+    }
+}
+
 QString isoString(const QDateTime& dt) {
     if (!dt.isValid()) {
         return QString();
@@ -28,53 +126,156 @@ QDateTime fromIso(const QString& value) {
     return QDateTime::fromString(value, Qt::ISODate);
 }
 
-QString normalizedTerm(const QString& term) {
-    QString t = term.trimmed().toLower();
-    if (t.isEmpty()) {
-        return QString();
+// Column order shared by every SELECT; recordFromQuery() decodes by ordinal. The
+// summary projection is a prefix of the full one that leaves out the notes text.
+enum EventColumn {
+    ColId,
+    ColTitle,
+    ColStart,
+    ColEnd,
+    ColAllDay,
+    ColLocation,
+    ColTags,
+    ColIsExam,
+    ColIsDone,
+    ColDue,
+    ColColorHint,
+    ColPriority,
+    ColCategoryId,
+    ColSource,
+    ColExternalId,
+    ColEventType,
+    ColTz,
+    ColNotes
+};
+
+const char* const kEventColumnNames[] = {
+    "id", "title", "start", "end", "allDay", "location", "tags", "isExam", "isDone", "due",
+    "colorHint", "priority", "categoryId", "source", "externalId", "eventType", "tz", "notes",
+};
+
+QString selectColumns(EventProjection projection, const QString& table = QString()) {
+    const int count = projection == EventProjection::Full ? ColNotes + 1 : ColNotes;
+    QStringList columns;
+    columns.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QString name = QString::fromLatin1(kEventColumnNames[i]);
+        columns.append(table.isEmpty() ? name : table + QLatin1Char('.') + name);
+    }
+    return QStringLiteral("SELECT ") + columns.join(QStringLiteral(", "));
+}
+
+// Turns free text into an FTS5 query: every word becomes a quoted prefix term and
+// all terms must match. Quoting keeps user input from being parsed as FTS syntax.
+QString ftsMatchExpression(const QString& term) {
+    QStringList parts;
+    const QStringList words = event_schema::foldGerman(term).split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
+    for (QString word : words) {
+        word.remove(QLatin1Char('"'));
+        word.remove(QLatin1Char('%'));
+        word.remove(QLatin1Char('*'));
+        if (word.isEmpty()) {
+            continue;
+        }
+        parts.append(QStringLiteral("\"%1\"*").arg(word));
     }
-    if (!t.contains('%')) {
-        t = QStringLiteral("%%1%").arg(t);
+    return parts.join(QLatin1Char(' '));
+}
+
+// Splits "#tag" words off a search term. Returns the tag keys; the remaining words
+// are written to textOut.
+QStringList splitTagFilters(const QString& term, QString* textOut) {
+    QStringList keys;
+    QStringList words;
+    const QStringList tokens = term.split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
+    for (const auto& token : tokens) {
+        if (token.size() > 1 && token.startsWith(QLatin1Char('#'))) {
+            keys.append(event_schema::tagKey(token.mid(1)));
+        } else {
+            words.append(token);
+        }
     }
-    return t;
+    keys.removeDuplicates();
+    *textOut = words.join(QLatin1Char(' '));
+    return keys;
 }
 
-bool ensureColumn(QSqlDatabase& db, const QString& table, const QString& column, const QString& typeDefinition) {
-    QSqlQuery pragma(db);
-    if (!pragma.exec(QStringLiteral("PRAGMA table_info(%1)").arg(table))) {
-        qWarning() << "[EventRepository] Unable to inspect schema for" << table << pragma.lastError();
-        return false;
+QStringList tagKeys(const QStringList& tags) {
+    QStringList keys;
+    keys.reserve(tags.size());
+    for (const auto& tag : tags) {
+        const QString key = event_schema::tagKey(tag);
+        if (!key.isEmpty()) {
+            keys.append(key);
+        }
+    }
+    keys.removeDuplicates();
+    return keys;
+}
+
+// Event ids carrying the given tag keys, bound as :tag0..:tagN. For All, an event
+// must have one event_tags row per key.
+QString tagSubquery(int count, TagMatch match) {
+    QStringList placeholders;
+    placeholders.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        placeholders.append(QStringLiteral(":tag%1").arg(i));
+    }
+    QString sql = QStringLiteral("SELECT event_id FROM event_tags WHERE tag IN (%1)").arg(placeholders.join(QStringLiteral(", ")));
+    if (match == TagMatch::All && count > 1) {
+        sql += QStringLiteral(" GROUP BY event_id HAVING COUNT(*) = %1").arg(count);
+    }
+    return sql;
+}
+
+void bindTagKeys(QSqlQuery& query, const QStringList& keys) {
+    for (int i = 0; i < keys.size(); ++i) {
+        query.bindValue(QStringLiteral(":tag%1").arg(i), keys.at(i));
     }
-    while (pragma.next()) {
-        if (pragma.value(QStringLiteral("name")).toString().compare(column, Qt::CaseInsensitive) == 0) {
+}
+
+bool matchesTags(const EventRecord& record, const QStringList& keys, TagMatch match) {
+    const QStringList own = tagKeys(record.tags);
+    for (const auto& key : keys) {
+        const bool has = own.contains(key);
+        if (match == TagMatch::Any && has) {
             return true;
         }
+        if (match == TagMatch::All && !has) {
+            return false;
+        }
     }
-    QSqlQuery alter(db);
-    const QString sql = QStringLiteral("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, typeDefinition);
-    if (!alter.exec(sql)) {
-        qWarning() << "[EventRepository] Failed to add column" << column << alter.lastError();
-        return false;
+    return match == TagMatch::All;
+}
+
+// Empty source/externalId are stored as NULL so manual events never collide in
+// idx_events_source_external_id.
+QVariant nullIfEmpty(const QString& value) {
+    return value.isEmpty() ? QVariant() : QVariant(value);
+}
+
+QString normalizedTerm(const QString& term) {
+    QString t = term.trimmed().toLower();
+    if (t.isEmpty()) {
+        return QString();
     }
-    return true;
+    if (!t.contains('%')) {
+        t = QStringLiteral("%%1%").arg(t);
+    }
+    return t;
 }
 }
 
 EventRepository::EventRepository()
-    : m_connectionName(QStringLiteral("planner_events_%1").arg(reinterpret_cast<quintptr>(this), 0, 16)) {
+    : m_profile(storage_profile::resolve(QString()))
+    , m_connections(QStringLiteral("planner_events_%1").arg(reinterpret_cast<quintptr>(this), 0, 16)) {
 }
 
 EventRepository::~EventRepository() {
-    if (!m_sqlAvailable) {
-        return;
-    }
-    if (QSqlDatabase::contains(m_connectionName)) {
-        QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
-        if (db.isValid()) {
-            db.close();
-        }
-        QSqlDatabase::removeDatabase(m_connectionName);
+    if (m_profiler) {
+        m_profiler->dumpSummary();
     }
+    m_connections.close();
 }
 
 bool EventRepository::initialize(const QString& storageDir) {
@@ -86,141 +287,380 @@ bool EventRepository::initialize(const QString& storageDir) {
 
     m_dbPath = dir.filePath(QStringLiteral("events.sqlite"));
     m_jsonPath = dir.filePath(QStringLiteral("events.json"));
+    m_journalPath = dir.filePath(QStringLiteral("events.journal"));
+    {
+        QMutexLocker locker(&m_jsonMutex);
+        m_jsonCache = JsonCache();
+    }
 
-    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_connectionName);
-    db.setDatabaseName(m_dbPath);
-    if (!db.open()) {
-        qWarning() << "[EventRepository] SQLite unavailable, falling back to JSON" << db.lastError().text();
-        QSqlDatabase::removeDatabase(m_connectionName);
+    m_connections.setConnectionPragmas(storage_profile::connectionPragmas(m_profile));
+    m_connections.setOptimizeOnClose(storage_profile::optimizeOnClose(m_profile));
+    if (!m_connections.open(m_dbPath)) {
+        qWarning() << "[EventRepository] SQLite unavailable, falling back to JSON" << m_connections.lastError();
         m_sqlAvailable = false;
 
-        if (!QFile::exists(m_jsonPath)) {
-            QFile file(m_jsonPath);
-            if (file.open(QIODevice::WriteOnly)) {
-                file.write("[]");
-                file.close();
-            }
+        if (!data_file::exists(m_jsonPath)) {
+            writeJsonArray(QJsonArray());
         }
+        compactJournalIfLarge();
         return true;
     }
 
     m_sqlAvailable = true;
+    if (!m_profiler) {
+        setQueryProfiling(QueryProfiler::fromEnvironment(dir.filePath(QStringLiteral("slow-queries.log"))));
+    }
 
+    QSqlDatabase db = m_connections.connection();
+    event_schema::prepareNewDatabase(db);
     QSqlQuery pragma(db);
     pragma.exec(QStringLiteral("PRAGMA journal_mode=WAL"));
+    pragma.finish();
 
-    QSqlQuery create(db);
-    const QString ddl = QStringLiteral(
-        "CREATE TABLE IF NOT EXISTS events ("
-        "id TEXT PRIMARY KEY NOT NULL,"
-        "title TEXT NOT NULL,"
-        "start DATETIME NOT NULL,"
-        "end DATETIME,"
-        "allDay INTEGER NOT NULL DEFAULT 0,"
-        "location TEXT,"
-        "notes TEXT,"
-        "tags TEXT,"
-        "isExam INTEGER NOT NULL DEFAULT 0,"
-        "isDone INTEGER NOT NULL DEFAULT 0,"
-        "due DATETIME,"
-        "colorHint TEXT,"
-    "priority INTEGER NOT NULL DEFAULT 0,"
-    "categoryId TEXT,"
-    "source TEXT,"
-    "externalId TEXT,"
-    "eventType TEXT,"
-        "createdAt DATETIME NOT NULL,"
-        "updatedAt DATETIME NOT NULL"
-        ");");
-    if (!create.exec(ddl)) {
-        qWarning() << "[EventRepository] Failed to create table" << create.lastError();
+    if (!event_schema::migrate(db)) {
+        qWarning() << "[EventRepository] Schema migration failed, falling back to JSON";
         m_sqlAvailable = false;
-        db.close();
-        QSqlDatabase::removeDatabase(m_connectionName);
-        if (!QFile::exists(m_jsonPath)) {
-            QFile file(m_jsonPath);
-            if (file.open(QIODevice::WriteOnly)) {
-                file.write("[]");
-                file.close();
-            }
+        db = QSqlDatabase();
+        m_connections.close();
+        if (!data_file::exists(m_jsonPath)) {
+            writeJsonArray(QJsonArray());
         }
+        compactJournalIfLarge();
         return true;
     }
 
-    ensureColumn(db, QStringLiteral("events"), QStringLiteral("categoryId"), QStringLiteral("TEXT"));
-    ensureColumn(db, QStringLiteral("events"), QStringLiteral("source"), QStringLiteral("TEXT"));
-    ensureColumn(db, QStringLiteral("events"), QStringLiteral("externalId"), QStringLiteral("TEXT"));
-    ensureColumn(db, QStringLiteral("events"), QStringLiteral("eventType"), QStringLiteral("TEXT"));
+    if (const std::optional<qint64> newest = changeSequence(); newest && *newest > kChangeLogRetention) {
+        pruneChanges(*newest - kChangeLogRetention);
+    }
 
-    QSqlQuery idxStart(db);
-    idxStart.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_start ON events(start);"));
-    QSqlQuery idxTags(db);
-    idxTags.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_tags ON events(tags);"));
-    QSqlQuery idxSource(db);
-    idxSource.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_source_external ON events(source, externalId);"));
+    m_ftsAvailable = event_schema::hasTable(db, QStringLiteral("events_fts"));
+    if (!m_ftsAvailable) {
+        qInfo() << "[EventRepository] FTS5 unavailable, search falls back to LIKE scan";
+    }
 
     return true;
 }
 
-QVector<EventRecord> EventRepository::loadAll(bool onlyOpen) const {
+QVector<EventRecord> EventRepository::loadAll(bool onlyOpen, EventProjection projection) const {
     if (!m_sqlAvailable) {
         return loadFromJson(onlyOpen);
     }
-    QSqlDatabase db = database();
-    if (!db.isValid()) {
+    QSqlQuery* query = statement(variantOf(Statement::LoadAll, onlyOpen, projection));
+    if (!query) {
         return {};
     }
-    QSqlQuery query(db);
-    QString sql = QStringLiteral("SELECT * FROM events");
-    if (onlyOpen) {
-        sql += QStringLiteral(" WHERE isDone = 0");
-    }
-    sql += QStringLiteral(" ORDER BY start ASC");
-    if (!query.exec(sql)) {
-        qWarning() << "[EventRepository] loadAll failed" << query.lastError();
+    QueryProfiler::Timing timing = profile("loadAll", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] loadAll failed" << query->lastError();
         return {};
     }
-    return runQuery(query);
+    QVector<EventRecord> records = runQuery(*query, projection);
+    timing.finish(records.size());
+    query->finish();
+    return records;
 }
 
-QVector<EventRecord> EventRepository::loadBetween(const QDate& start, const QDate& end, bool onlyOpen) const {
+QVector<EventRecord> EventRepository::loadBetween(const QDate& start, const QDate& end, bool onlyOpen,
+                                                  EventProjection projection) const {
     if (!m_sqlAvailable) {
         return loadRangeFromJson(start, end, onlyOpen);
     }
-    QSqlDatabase db = database();
-    if (!db.isValid()) {
+    QSqlQuery* query = statement(variantOf(Statement::LoadBetween, onlyOpen, projection));
+    if (!query) {
         return {};
     }
-    QSqlQuery query(db);
-    QString sql = QStringLiteral("SELECT * FROM events WHERE date(start) BETWEEN :start AND :end");
-    if (onlyOpen) {
-        sql += QStringLiteral(" AND isDone = 0");
+    query->bindValue(0, start.toJulianDay());
+    query->bindValue(1, end.toJulianDay());
+    QueryProfiler::Timing timing = profile("loadBetween", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] loadBetween exec failed" << query->lastError();
+        return {};
     }
-    sql += QStringLiteral(" ORDER BY start ASC");
-    if (!query.prepare(sql)) {
-        qWarning() << "[EventRepository] loadBetween prepare failed" << query.lastError();
+    QVector<EventRecord> records = runQuery(*query, projection);
+    timing.finish(records.size());
+    query->finish();
+    return records;
+}
+
+QVector<EventRecord> EventRepository::openBetween(const QDateTime& from, const QDateTime& to,
+                                                  EventProjection projection) const {
+    if (!from.isValid() || !to.isValid()) {
         return {};
     }
-    query.bindValue(QStringLiteral(":start"), start.toString(Qt::ISODate));
-    query.bindValue(QStringLiteral(":end"), end.toString(Qt::ISODate));
-    if (!query.exec()) {
-        qWarning() << "[EventRepository] loadBetween exec failed" << query.lastError();
+    if (!m_sqlAvailable) {
+        QVector<EventRecord> records = loadFromJson(true);
+        records.erase(std::remove_if(records.begin(), records.end(),
+                                     [&](const EventRecord& record) { return record.start < from || record.start >= to; }),
+                      records.end());
+        return records;
+    }
+    QSqlQuery* query = statement(projection == EventProjection::Summary ? Statement::OpenBetweenSummary
+                                                                          : Statement::OpenBetween);
+    if (!query) {
+        return {};
+    }
+    query->bindValue(0, from.toMSecsSinceEpoch());
+    query->bindValue(1, to.toMSecsSinceEpoch());
+    QueryProfiler::Timing timing = profile("openBetween", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] openBetween exec failed" << query->lastError();
+        return {};
+    }
+    QVector<EventRecord> records = runQuery(*query, projection);
+    timing.finish(records.size());
+    query->finish();
+    return records;
+}
+
+QVector<EventRecord> EventRepository::upcomingExams(const QDate& from, int limit, EventProjection projection) const {
+    if (!from.isValid() || limit <= 0) {
+        return {};
+    }
+    const QDateTime fromStart(from, QTime(0, 0));
+    if (!m_sqlAvailable) {
+        QVector<EventRecord> records = loadFromJson(false);
+        records.erase(std::remove_if(records.begin(), records.end(),
+                                     [&](const EventRecord& record) { return !record.isExam || record.start < fromStart; }),
+                      records.end());
+        if (records.size() > limit) {
+            records.resize(limit);
+        }
+        return records;
+    }
+    QSqlQuery* query = statement(projection == EventProjection::Summary ? Statement::UpcomingExamsSummary
+                                                                          : Statement::UpcomingExams);
+    if (!query) {
+        return {};
+    }
+    query->bindValue(0, fromStart.toMSecsSinceEpoch());
+    query->bindValue(1, limit);
+    QueryProfiler::Timing timing = profile("upcomingExams", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] upcomingExams exec failed" << query->lastError();
+        return {};
+    }
+    QVector<EventRecord> records = runQuery(*query, projection);
+    timing.finish(records.size());
+    query->finish();
+    return records;
+}
+
+std::optional<EventPage> EventRepository::fetchPage(const EventCursor& after, const QDateTime& until, int pageSize,
+                                                    bool onlyOpen, EventProjection projection) const {
+    if (pageSize <= 0) {
+        return std::nullopt;
+    }
+    const qint64 untilMs = until.isValid() ? until.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+    EventPage page;
+    if (!m_sqlAvailable) {
+        QVector<EventRecord> records = loadFromJson(onlyOpen);
+        std::sort(records.begin(), records.end(), [](const EventRecord& a, const EventRecord& b) {
+            const qint64 aStart = a.start.toMSecsSinceEpoch();
+            const qint64 bStart = b.start.toMSecsSinceEpoch();
+            return aStart != bStart ? aStart < bStart : a.id < b.id;
+        });
+        for (const auto& record : records) {
+            const qint64 start = record.start.toMSecsSinceEpoch();
+            if (start < after.start || (start == after.start && record.id <= after.id)) {
+                continue;
+            }
+            if (start >= untilMs || page.records.size() == pageSize) {
+                break;
+            }
+            page.records.append(record);
+        }
+    } else {
+        QSqlQuery* query = statement(variantOf(Statement::Page, onlyOpen, projection));
+        if (!query) {
+            return std::nullopt;
+        }
+        query->bindValue(0, after.start);
+        query->bindValue(1, after.id);
+        query->bindValue(2, untilMs);
+        query->bindValue(3, pageSize);
+        QueryProfiler::Timing timing = profile("fetchPage", *query);
+        if (!query->exec()) {
+            qWarning() << "[EventRepository] fetchPage exec failed" << query->lastError();
+            return std::nullopt;
+        }
+        page.records = runQuery(*query, projection);
+        timing.finish(page.records.size());
+        query->finish();
+    }
+    page.hasMore = page.records.size() == pageSize;
+    page.next = page.records.isEmpty()
+        ? after
+        : EventCursor{page.records.last().start.toMSecsSinceEpoch(), page.records.last().id};
+    return page;
+}
+
+bool EventRepository::forEachPage(const EventCursor& from, const QDateTime& until, int pageSize, bool onlyOpen,
+                                  EventProjection projection,
+                                  const std::function<bool(const QVector<EventRecord>&)>& consumer) const {
+    EventCursor cursor = from;
+    while (true) {
+        const std::optional<EventPage> page = fetchPage(cursor, until, pageSize, onlyOpen, projection);
+        if (!page) {
+            return false;
+        }
+        if (!page->records.isEmpty() && !consumer(page->records)) {
+            return true;
+        }
+        if (!page->hasMore) {
+            return true;
+        }
+        cursor = page->next;
+    }
+}
+
+std::optional<EventRecord> EventRepository::findById(const QString& id) const {
+    if (id.isEmpty()) {
+        return std::nullopt;
+    }
+    if (!m_sqlAvailable) {
+        QMutexLocker locker(&m_jsonMutex);
+        refreshJsonCache();
+        const auto it = m_jsonCache.byId.constFind(id);
+        if (it == m_jsonCache.byId.constEnd()) {
+            return std::nullopt;
+        }
+        EventRecord record = it.value();
+        record.priority = computePriority(record, QDate::currentDate());
+        return record;
+    }
+
+    QSqlQuery* query = statement(Statement::FindById);
+    if (!query) {
+        return std::nullopt;
+    }
+    query->bindValue(0, id);
+    QueryProfiler::Timing timing = profile("findById", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] findById exec failed" << query->lastError();
+        return std::nullopt;
+    }
+    const bool found = query->next();
+    timing.finish(found ? 1 : 0);
+    if (!found) {
+        query->finish();
+        return std::nullopt;
+    }
+    EventRecord record = recordFromQuery(*query, EventProjection::Full);
+    query->finish();
+    record.priority = computePriority(record, QDate::currentDate());
+    return record;
+}
+
+QVector<EventRecord> EventRepository::findByIds(const QStringList& ids, EventProjection projection) const {
+    if (ids.isEmpty()) {
         return {};
     }
-    return runQuery(query);
+    if (!m_sqlAvailable) {
+        const QSet<QString> wanted(ids.cbegin(), ids.cend());
+        const QDate today = QDate::currentDate();
+        QVector<EventRecord> records;
+        QMutexLocker locker(&m_jsonMutex);
+        refreshJsonCache();
+        for (const auto& id : wanted) {
+            const auto it = m_jsonCache.byId.constFind(id);
+            if (it != m_jsonCache.byId.constEnd()) {
+                records.append(it.value());
+                records.last().priority = computePriority(records.last(), today);
+            }
+        }
+        locker.unlock();
+        std::sort(records.begin(), records.end(), [](const EventRecord& a, const EventRecord& b) {
+            return a.start < b.start;
+        });
+        return records;
+    }
+    QSqlDatabase db = database();
+    if (!db.isValid()) {
+        return {};
+    }
+    // Chunked to stay well below SQLite's bound parameter limit.
+    constexpr int kChunk = 500;
+    QVector<EventRecord> records;
+    for (int offset = 0; offset < ids.size(); offset += kChunk) {
+        const QStringList chunk = ids.mid(offset, kChunk);
+        QStringList placeholders;
+        placeholders.fill(QStringLiteral("?"), chunk.size());
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.prepare(selectColumns(projection)
+                           + QStringLiteral(" FROM events WHERE id IN (%1)").arg(placeholders.join(QLatin1Char(','))))) {
+            qWarning() << "[EventRepository] findByIds prepare failed" << query.lastError();
+            return {};
+        }
+        for (int i = 0; i < chunk.size(); ++i) {
+            query.bindValue(i, chunk.at(i));
+        }
+        QueryProfiler::Timing timing = profile("findByIds", query);
+        if (!query.exec()) {
+            qWarning() << "[EventRepository] findByIds exec failed" << query.lastError();
+            return {};
+        }
+        const QVector<EventRecord> found = runQuery(query, projection);
+        timing.finish(found.size());
+        records += found;
+    }
+    std::sort(records.begin(), records.end(), [](const EventRecord& a, const EventRecord& b) {
+        return a.start < b.start;
+    });
+    return records;
 }
 
-QVector<EventRecord> EventRepository::search(const QString& term, bool onlyOpen) const {
+QVector<EventRecord> EventRepository::search(const QString& rawTerm, bool onlyOpen) const {
+    QString term;
+    const QStringList tagFilters = splitTagFilters(rawTerm, &term);
     if (!m_sqlAvailable) {
-        return searchInJson(term, onlyOpen);
+        return searchInJson(term, tagFilters, onlyOpen);
+    }
+    if (!tagFilters.isEmpty() && term.isEmpty()) {
+        return findByTags(tagFilters, TagMatch::All, onlyOpen);
     }
-    const QString likeTerm = normalizedTerm(term);
     QSqlDatabase db = database();
     if (!db.isValid()) {
         return {};
     }
+    const QString tagClause = tagFilters.isEmpty()
+        ? QString()
+        : QStringLiteral(" AND events.id IN (%1)").arg(tagSubquery(tagFilters.size(), TagMatch::All));
+    const QString match = m_ftsAvailable ? ftsMatchExpression(term) : QString();
+    if (m_ftsAvailable && match.isEmpty() && !term.trimmed().isEmpty()) {
+        // Nothing searchable left (e.g. only "*" or quotes); the scan below would
+        // otherwise return every event.
+        return {};
+    }
+    if (!match.isEmpty()) {
+        QSqlQuery query(db);
+        QString sql = selectColumns(EventProjection::Full, QStringLiteral("events"))
+            + QStringLiteral(" FROM events_fts JOIN events ON events.rowid = events_fts.rowid WHERE events_fts MATCH :match")
+            + tagClause;
+        if (onlyOpen) {
+            sql += QStringLiteral(" AND events.isDone = 0");
+        }
+        // Column weights: title, location, notes, tags.
+        sql += QStringLiteral(" ORDER BY bm25(events_fts, 10.0, 4.0, 1.0, 6.0), events.start ASC");
+        if (!query.prepare(sql)) {
+            qWarning() << "[EventRepository] search prepare failed" << query.lastError();
+            return {};
+        }
+        query.bindValue(QStringLiteral(":match"), match);
+        bindTagKeys(query, tagFilters);
+        QueryProfiler::Timing timing = profile("search.fts", query);
+        if (!query.exec()) {
+            qWarning() << "[EventRepository] search exec failed" << query.lastError();
+            return {};
+        }
+        const QVector<EventRecord> records = runQuery(query, EventProjection::Full);
+        timing.finish(records.size());
+        return records;
+    }
+
+    const QString likeTerm = m_ftsAvailable ? QString() : normalizedTerm(term);
     QSqlQuery query(db);
-    QString sql = QStringLiteral("SELECT * FROM events WHERE 1=1");
+    QString sql = selectColumns(EventProjection::Full, QStringLiteral("events")) + QStringLiteral(" FROM events WHERE 1=1") + tagClause;
     if (!likeTerm.isEmpty()) {
         sql += QStringLiteral(" AND (lower(title) LIKE :term OR lower(location) LIKE :term OR lower(tags) LIKE :term)");
     }
@@ -235,147 +675,320 @@ QVector<EventRecord> EventRepository::search(const QString& term, bool onlyOpen)
     if (!likeTerm.isEmpty()) {
         query.bindValue(QStringLiteral(":term"), likeTerm);
     }
+    bindTagKeys(query, tagFilters);
+    QueryProfiler::Timing timing = profile("search.scan", query);
     if (!query.exec()) {
         qWarning() << "[EventRepository] search exec failed" << query.lastError();
         return {};
     }
-    return runQuery(query);
+    const QVector<EventRecord> records = runQuery(query, EventProjection::Full);
+    timing.finish(records.size());
+    return records;
 }
 
-bool EventRepository::insert(EventRecord& record) {
+QVector<EventRecord> EventRepository::findByTag(const QString& tag, bool onlyOpen, EventProjection projection) const {
+    return findByTags(QStringList{tag}, TagMatch::Any, onlyOpen, projection);
+}
+
+QVector<EventRecord> EventRepository::findByTags(const QStringList& tags, TagMatch match, bool onlyOpen,
+                                                 EventProjection projection) const {
+    const QStringList keys = tagKeys(tags);
+    if (keys.isEmpty()) {
+        return {};
+    }
     if (!m_sqlAvailable) {
-        return insertJson(record);
+        QVector<EventRecord> records = loadFromJson(onlyOpen);
+        records.erase(std::remove_if(records.begin(), records.end(),
+                                     [&](const EventRecord& record) { return !matchesTags(record, keys, match); }),
+                      records.end());
+        return records;
     }
     QSqlDatabase db = database();
     if (!db.isValid()) {
-        return false;
-    }
-    if (record.id.isEmpty()) {
-        record.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        return {};
     }
-    const QDateTime now = QDateTime::currentDateTimeUtc();
-    const QString tagJson = QJsonDocument(QJsonArray::fromStringList(record.tags)).toJson(QJsonDocument::Compact);
-
     QSqlQuery query(db);
-    const QString sql = QStringLiteral(
-        "INSERT INTO events (id, title, start, end, allDay, location, notes, tags, isExam, isDone, due, colorHint, priority, categoryId, source, externalId, eventType, createdAt, updatedAt) "
-        "VALUES (:id, :title, :start, :end, :allDay, :location, :notes, :tags, :isExam, :isDone, :due, :colorHint, :priority, :categoryId, :source, :externalId, :eventType, :createdAt, :updatedAt)");
+    query.setForwardOnly(true);
+    QString sql = selectColumns(projection) + QStringLiteral(" FROM events WHERE id IN (%1)").arg(tagSubquery(keys.size(), match));
+    if (onlyOpen) {
+        sql += QStringLiteral(" AND isDone = 0");
+    }
+    sql += QStringLiteral(" ORDER BY start ASC");
     if (!query.prepare(sql)) {
-        qWarning() << "[EventRepository] insert prepare failed" << query.lastError();
-        return false;
-    }
-    const QString startIso = isoString(record.start);
-    const QString endIso = record.end.isValid() ? isoString(record.end) : QString();
-    query.bindValue(QStringLiteral(":id"), record.id);
-    query.bindValue(QStringLiteral(":title"), record.title);
-    query.bindValue(QStringLiteral(":start"), startIso);
-    query.bindValue(QStringLiteral(":end"), endIso.isEmpty() ? QVariant() : QVariant(endIso));
-    query.bindValue(QStringLiteral(":allDay"), record.allDay ? 1 : 0);
-    query.bindValue(QStringLiteral(":location"), record.location);
-    query.bindValue(QStringLiteral(":notes"), record.notes);
-    query.bindValue(QStringLiteral(":tags"), tagJson);
-    query.bindValue(QStringLiteral(":isExam"), record.isExam ? 1 : 0);
-    query.bindValue(QStringLiteral(":isDone"), record.isDone ? 1 : 0);
-    const QString dueIso = record.due.isValid() ? isoString(record.due) : QString();
-    query.bindValue(QStringLiteral(":due"), dueIso.isEmpty() ? QVariant() : QVariant(dueIso));
-    query.bindValue(QStringLiteral(":colorHint"), record.colorHint);
-    query.bindValue(QStringLiteral(":priority"), record.priority);
-    query.bindValue(QStringLiteral(":categoryId"), record.categoryId);
-    query.bindValue(QStringLiteral(":source"), record.source);
-    query.bindValue(QStringLiteral(":externalId"), record.externalId);
-    query.bindValue(QStringLiteral(":eventType"), record.eventType);
-    query.bindValue(QStringLiteral(":createdAt"), isoString(now));
-    query.bindValue(QStringLiteral(":updatedAt"), isoString(now));
-
+        qWarning() << "[EventRepository] findByTags prepare failed" << query.lastError();
+        return {};
+    }
+    bindTagKeys(query, keys);
+    QueryProfiler::Timing timing = profile("findByTags", query);
     if (!query.exec()) {
-        qWarning() << "[EventRepository] insert exec failed" << query.lastError();
+        qWarning() << "[EventRepository] findByTags exec failed" << query.lastError();
+        return {};
+    }
+    const QVector<EventRecord> records = runQuery(query, projection);
+    timing.finish(records.size());
+    return records;
+}
+
+bool EventRepository::insert(EventRecord& record) {
+    if (!m_sqlAvailable) {
+        return insertJson(record);
+    }
+    if (!onWriterThread("insert")) {
         return false;
     }
-    return true;
+    return inTransaction([&] { return insertSql(record); });
 }
 
 bool EventRepository::setDone(const QString& id, bool done) {
     if (!m_sqlAvailable) {
         return setDoneJson(id, done);
     }
-    QSqlDatabase db = database();
-    if (!db.isValid()) {
+    if (!onWriterThread("setDone")) {
         return false;
     }
-    QSqlQuery query(db);
-    if (!query.prepare(QStringLiteral("UPDATE events SET isDone = :done, updatedAt = :updatedAt WHERE id = :id"))) {
-        qWarning() << "[EventRepository] setDone prepare failed" << query.lastError();
+    QSqlQuery* query = statement(Statement::SetDone);
+    if (!query) {
         return false;
     }
-    query.bindValue(QStringLiteral(":done"), done ? 1 : 0);
-    query.bindValue(QStringLiteral(":updatedAt"), isoString(QDateTime::currentDateTimeUtc()));
-    query.bindValue(QStringLiteral(":id"), id);
-    if (!query.exec()) {
-        qWarning() << "[EventRepository] setDone exec failed" << query.lastError();
+    query->bindValue(0, done ? 1 : 0);
+    query->bindValue(1, QDateTime::currentMSecsSinceEpoch());
+    query->bindValue(2, id);
+    QueryProfiler::Timing timing = profile("setDone", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] setDone exec failed" << query->lastError();
         return false;
     }
-    return query.numRowsAffected() > 0;
+    timing.finish(query->numRowsAffected());
+    return query->numRowsAffected() > 0;
 }
 
 bool EventRepository::update(const EventRecord& record) {
     if (!m_sqlAvailable) {
         return updateJson(record);
     }
-    QSqlDatabase db = database();
-    if (!db.isValid()) {
-        return false;
-    }
-    QSqlQuery query(db);
-    if (!query.prepare(QStringLiteral(
-            "UPDATE events SET title=:title, start=:start, end=:end, allDay=:allDay, location=:location, notes=:notes, tags=:tags,"
-            " isExam=:isExam, isDone=:isDone, due=:due, colorHint=:colorHint, priority=:priority, categoryId=:categoryId, source=:source, externalId=:externalId, eventType=:eventType, updatedAt=:updatedAt WHERE id=:id"))) {
-        qWarning() << "[EventRepository] update prepare failed" << query.lastError();
-        return false;
-    }
-    query.bindValue(QStringLiteral(":title"), record.title);
-    query.bindValue(QStringLiteral(":start"), isoString(record.start));
-    query.bindValue(QStringLiteral(":end"), record.end.isValid() ? QVariant(isoString(record.end)) : QVariant());
-    query.bindValue(QStringLiteral(":allDay"), record.allDay ? 1 : 0);
-    query.bindValue(QStringLiteral(":location"), record.location);
-    query.bindValue(QStringLiteral(":notes"), record.notes);
-    query.bindValue(QStringLiteral(":tags"), QJsonDocument(QJsonArray::fromStringList(record.tags)).toJson(QJsonDocument::Compact));
-    query.bindValue(QStringLiteral(":isExam"), record.isExam ? 1 : 0);
-    query.bindValue(QStringLiteral(":isDone"), record.isDone ? 1 : 0);
-    query.bindValue(QStringLiteral(":due"), record.due.isValid() ? QVariant(isoString(record.due)) : QVariant());
-    query.bindValue(QStringLiteral(":colorHint"), record.colorHint);
-    query.bindValue(QStringLiteral(":priority"), record.priority);
-    query.bindValue(QStringLiteral(":categoryId"), record.categoryId);
-    query.bindValue(QStringLiteral(":source"), record.source);
-    query.bindValue(QStringLiteral(":externalId"), record.externalId);
-    query.bindValue(QStringLiteral(":eventType"), record.eventType);
-    query.bindValue(QStringLiteral(":updatedAt"), isoString(QDateTime::currentDateTimeUtc()));
-    query.bindValue(QStringLiteral(":id"), record.id);
-    if (!query.exec()) {
-        qWarning() << "[EventRepository] update exec failed" << query.lastError();
+    if (!onWriterThread("update")) {
         return false;
     }
-    return query.numRowsAffected() > 0;
+    return inTransaction([&] { return updateSql(record); });
 }
 
 bool EventRepository::remove(const QString& id) {
     if (!m_sqlAvailable) {
         return removeJson(id);
     }
-    QSqlDatabase db = database();
-    if (!db.isValid()) {
+    if (!onWriterThread("remove")) {
         return false;
     }
-    QSqlQuery query(db);
-    if (!query.prepare(QStringLiteral("DELETE FROM events WHERE id = :id"))) {
-        qWarning() << "[EventRepository] remove prepare failed" << query.lastError();
+    return removeSql(id);
+}
+
+EventBatchResult EventRepository::applyBatch(QVector<EventRecord>& inserts,
+                                             const QVector<EventRecord>& updates,
+                                             const QStringList& removals) {
+    if (!m_sqlAvailable) {
+        return applyBatchJson(inserts, updates, removals);
+    }
+    EventBatchResult result;
+    QSqlDatabase db = onWriterThread("applyBatch") ? database() : QSqlDatabase();
+    if (!db.isValid() || !db.transaction()) {
+        qWarning() << "[EventRepository] applyBatch could not open transaction" << db.lastError();
+        result.updated.fill(false, updates.size());
+        result.inserted.fill(false, inserts.size());
+        result.removed.fill(false, removals.size());
+        return result;
+    }
+
+    result.updated.reserve(updates.size());
+    for (const auto& record : updates) {
+        result.updated.append(inSavepoint([&]() { return updateSql(record); }));
+    }
+    result.inserted.reserve(inserts.size());
+    for (auto& record : inserts) {
+        result.inserted.append(inSavepoint([&]() { return insertSql(record); }));
+    }
+    result.removed.reserve(removals.size());
+    for (const auto& id : removals) {
+        result.removed.append(removeSql(id));
+    }
+
+    QueryProfiler::Timing commitTiming = profileCommit("applyBatch.commit");
+    if (!db.commit()) {
+        qWarning() << "[EventRepository] applyBatch commit failed" << db.lastError();
+        db.rollback();
+        result.updated.fill(false);
+        result.inserted.fill(false);
+        result.removed.fill(false);
+        return result;
+    }
+    result.committed = true;
+    return result;
+}
+
+bool EventRepository::insertSql(EventRecord& record) {
+    QSqlQuery* query = statement(Statement::Insert);
+    if (!query) {
         return false;
     }
-    query.bindValue(QStringLiteral(":id"), id);
-    if (!query.exec()) {
-        qWarning() << "[EventRepository] remove exec failed" << query.lastError();
+    if (record.id.isEmpty()) {
+        record.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    }
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    query->bindValue(0, record.id);
+    query->bindValue(1, record.title);
+    query->bindValue(2, event_schema::epochValue(record.start));
+    query->bindValue(3, event_schema::epochValue(record.end));
+    query->bindValue(4, record.allDay ? 1 : 0);
+    query->bindValue(5, record.location);
+    query->bindValue(6, record.notes);
+    query->bindValue(7, QJsonDocument(QJsonArray::fromStringList(record.tags)).toJson(QJsonDocument::Compact));
+    query->bindValue(8, record.isExam ? 1 : 0);
+    query->bindValue(9, record.isDone ? 1 : 0);
+    query->bindValue(10, event_schema::epochValue(record.due));
+    query->bindValue(11, record.colorHint);
+    query->bindValue(12, record.priority);
+    query->bindValue(13, record.categoryId);
+    query->bindValue(14, nullIfEmpty(record.source));
+    query->bindValue(15, nullIfEmpty(record.externalId));
+    query->bindValue(16, record.eventType);
+    query->bindValue(17, now);
+    query->bindValue(18, now);
+    query->bindValue(19, event_schema::startDayValue(record.start));
+    query->bindValue(20, event_schema::timeZoneTag(record.start));
+    QueryProfiler::Timing timing = profile("insert", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] insert exec failed" << query->lastError();
         return false;
     }
-    return query.numRowsAffected() > 0;
+    timing.finish(query->numRowsAffected());
+    return writeTagsSql(record.id, record.tags);
+}
+
+bool EventRepository::updateSql(const EventRecord& record) {
+    QSqlQuery* query = statement(Statement::Update);
+    if (!query) {
+        return false;
+    }
+    query->bindValue(0, record.title);
+    query->bindValue(1, event_schema::epochValue(record.start));
+    query->bindValue(2, event_schema::epochValue(record.end));
+    query->bindValue(3, record.allDay ? 1 : 0);
+    query->bindValue(4, record.location);
+    query->bindValue(5, record.notes);
+    query->bindValue(6, QJsonDocument(QJsonArray::fromStringList(record.tags)).toJson(QJsonDocument::Compact));
+    query->bindValue(7, record.isExam ? 1 : 0);
+    query->bindValue(8, record.isDone ? 1 : 0);
+    query->bindValue(9, event_schema::epochValue(record.due));
+    query->bindValue(10, record.colorHint);
+    query->bindValue(11, record.priority);
+    query->bindValue(12, record.categoryId);
+    query->bindValue(13, nullIfEmpty(record.source));
+    query->bindValue(14, nullIfEmpty(record.externalId));
+    query->bindValue(15, record.eventType);
+    query->bindValue(16, QDateTime::currentMSecsSinceEpoch());
+    query->bindValue(17, event_schema::startDayValue(record.start));
+    query->bindValue(18, event_schema::timeZoneTag(record.start));
+    query->bindValue(19, record.id);
+    QueryProfiler::Timing timing = profile("update", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] update exec failed" << query->lastError();
+        return false;
+    }
+    timing.finish(query->numRowsAffected());
+    if (query->numRowsAffected() <= 0) {
+        return false;
+    }
+    return writeTagsSql(record.id, record.tags);
+}
+
+bool EventRepository::removeSql(const QString& id) {
+    QSqlQuery* query = statement(Statement::Remove);
+    if (!query) {
+        return false;
+    }
+    query->bindValue(0, id);
+    QueryProfiler::Timing timing = profile("remove", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] remove exec failed" << query->lastError();
+        return false;
+    }
+    timing.finish(query->numRowsAffected());
+    return query->numRowsAffected() > 0;
+}
+
+// Replaces the event_tags rows of an event. Rows of deleted events are removed by the
+// event_tags_ad trigger.
+bool EventRepository::writeTagsSql(const QString& id, const QStringList& tags) {
+    QSqlQuery* clear = statement(Statement::DeleteTags);
+    if (!clear) {
+        return false;
+    }
+    clear->bindValue(0, id);
+    QueryProfiler::Timing timing = profile("deleteTags", *clear);
+    if (!clear->exec()) {
+        qWarning() << "[EventRepository] tag update failed" << clear->lastError();
+        return false;
+    }
+    timing.finish(clear->numRowsAffected());
+    const QStringList keys = tagKeys(tags);
+    if (keys.isEmpty()) {
+        return true;
+    }
+    QSqlQuery* insert = statement(Statement::InsertTag);
+    if (!insert) {
+        return false;
+    }
+    for (const auto& key : keys) {
+        insert->bindValue(0, id);
+        insert->bindValue(1, key);
+        QueryProfiler::Timing tagTiming = profile("insertTag", *insert);
+        if (!insert->exec()) {
+            qWarning() << "[EventRepository] tag update failed" << insert->lastError();
+            return false;
+        }
+        tagTiming.finish(insert->numRowsAffected());
+    }
+    return true;
+}
+
+bool EventRepository::inTransaction(const std::function<bool()>& work) {
+    QSqlDatabase db = database();
+    if (!db.isValid() || !db.transaction()) {
+        qWarning() << "[EventRepository] Unable to open transaction" << db.lastError();
+        return false;
+    }
+    if (!work()) {
+        db.rollback();
+        return false;
+    }
+    QueryProfiler::Timing commitTiming = profileCommit("commit");
+    if (!db.commit()) {
+        qWarning() << "[EventRepository] Commit failed" << db.lastError();
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool EventRepository::inSavepoint(const std::function<bool()>& work) {
+    const auto run = [this](Statement which) {
+        QSqlQuery* query = statement(which);
+        if (!query || !query->exec()) {
+            qWarning() << "[EventRepository]" << statementSql(which) << "failed"
+                       << (query ? query->lastError() : QSqlError());
+            return false;
+        }
+        return true;
+    };
+    if (!run(Statement::BeginItem)) {
+        return false;
+    }
+    if (work() && run(Statement::ReleaseItem)) {
+        return true;
+    }
+    // ROLLBACK TO keeps the savepoint open; it still has to be released.
+    run(Statement::RollbackItem);
+    run(Statement::ReleaseItem);
+    return false;
 }
 
 std::optional<EventRecord> EventRepository::findByExternalId(const QString& source, const QString& externalId) const {
@@ -383,40 +996,36 @@ std::optional<EventRecord> EventRepository::findByExternalId(const QString& sour
         return std::nullopt;
     }
     if (!m_sqlAvailable) {
-        const QJsonArray array = readJsonArray();
-        const QDate today = QDate::currentDate();
-        for (const auto& value : array) {
-            if (!value.isObject()) {
-                continue;
-            }
-            EventRecord record = recordFromJson(value.toObject());
-            if (record.source == source && record.externalId == externalId) {
-                record.priority = computePriority(record, today);
-                return record;
-            }
+        QMutexLocker locker(&m_jsonMutex);
+        refreshJsonCache();
+        const auto it = m_jsonCache.idByExternalKey.constFind(externalKey(source, externalId));
+        if (it == m_jsonCache.idByExternalKey.constEnd()) {
+            return std::nullopt;
         }
-        return std::nullopt;
+        EventRecord record = m_jsonCache.byId.value(it.value());
+        record.priority = computePriority(record, QDate::currentDate());
+        return record;
     }
 
-    QSqlDatabase db = database();
-    if (!db.isValid()) {
-        return std::nullopt;
-    }
-    QSqlQuery query(db);
-    if (!query.prepare(QStringLiteral("SELECT * FROM events WHERE source = :source AND externalId = :externalId LIMIT 1"))) {
-        qWarning() << "[EventRepository] findByExternalId prepare failed" << query.lastError();
+    QSqlQuery* query = statement(Statement::FindByExternalId);
+    if (!query) {
         return std::nullopt;
     }
-    query.bindValue(QStringLiteral(":source"), source);
-    query.bindValue(QStringLiteral(":externalId"), externalId);
-    if (!query.exec()) {
-        qWarning() << "[EventRepository] findByExternalId exec failed" << query.lastError();
+    query->bindValue(0, source);
+    query->bindValue(1, externalId);
+    QueryProfiler::Timing timing = profile("findByExternalId", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] findByExternalId exec failed" << query->lastError();
         return std::nullopt;
     }
-    if (!query.next()) {
+    const bool found = query->next();
+    timing.finish(found ? 1 : 0);
+    if (!found) {
+        query->finish();
         return std::nullopt;
     }
-    EventRecord record = recordFromQuery(query);
+    EventRecord record = recordFromQuery(*query, EventProjection::Full);
+    query->finish();
     record.priority = computePriority(record, QDate::currentDate());
     return record;
 }
@@ -426,41 +1035,35 @@ QVector<EventRecord> EventRepository::findBySource(const QString& source) const
         return {};
     }
     if (!m_sqlAvailable) {
-        const QJsonArray array = readJsonArray();
         QVector<EventRecord> records;
         const QDate today = QDate::currentDate();
-        for (const auto& value : array) {
-            if (!value.isObject()) {
-                continue;
-            }
-            EventRecord record = recordFromJson(value.toObject());
-            if (record.source != source) {
+        QMutexLocker locker(&m_jsonMutex);
+        refreshJsonCache();
+        for (const auto& entry : std::as_const(m_jsonCache.byStart)) {
+            const EventRecord& cached = *m_jsonCache.byId.constFind(entry.second);
+            if (cached.source != source) {
                 continue;
             }
-            record.priority = computePriority(record, today);
-            records.append(record);
+            records.append(cached);
+            records.last().priority = computePriority(cached, today);
         }
-        std::sort(records.begin(), records.end(), [](const EventRecord& a, const EventRecord& b) {
-            return a.start < b.start;
-        });
         return records;
     }
 
-    QSqlDatabase db = database();
-    if (!db.isValid()) {
+    QSqlQuery* query = statement(Statement::FindBySource);
+    if (!query) {
         return {};
     }
-    QSqlQuery query(db);
-    if (!query.prepare(QStringLiteral("SELECT * FROM events WHERE source = :source ORDER BY start ASC"))) {
-        qWarning() << "[EventRepository] findBySource prepare failed" << query.lastError();
-        return {};
-    }
-    query.bindValue(QStringLiteral(":source"), source);
-    if (!query.exec()) {
-        qWarning() << "[EventRepository] findBySource exec failed" << query.lastError();
+    query->bindValue(0, source);
+    QueryProfiler::Timing timing = profile("findBySource", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] findBySource exec failed" << query->lastError();
         return {};
     }
-    return runQuery(query);
+    QVector<EventRecord> records = runQuery(*query, EventProjection::Full);
+    timing.finish(records.size());
+    query->finish();
+    return records;
 }
 
 bool EventRepository::removeBySource(const QString& source) {
@@ -468,26 +1071,30 @@ bool EventRepository::removeBySource(const QString& source) {
         return false;
     }
     if (!m_sqlAvailable) {
-        QJsonArray array = readJsonArray();
-        QJsonArray updated;
-        bool changed = false;
-        for (const auto& value : array) {
-            if (!value.isObject()) {
-                continue;
+        QMutexLocker locker(&m_jsonMutex);
+        refreshJsonCache();
+        QStringList matching;
+        for (const auto& record : std::as_const(m_jsonCache.byId)) {
+            if (record.source == source) {
+                matching.append(record.id);
             }
-            const QJsonObject obj = value.toObject();
-            if (obj.value(QStringLiteral("source")).toString() == source) {
-                changed = true;
-                continue;
-            }
-            updated.append(obj);
         }
-        if (!changed) {
+        if (matching.isEmpty()) {
+            return false;
+        }
+        if (!appendJournal({{QStringLiteral("op"), QStringLiteral("removeSource")}, {QStringLiteral("source"), source}})) {
             return false;
         }
-        return writeJsonArray(updated);
+        for (const auto& id : std::as_const(matching)) {
+            cacheRemove(m_jsonCache, id);
+        }
+        restampJsonCache();
+        return true;
     }
 
+    if (!onWriterThread("removeBySource")) {
+        return false;
+    }
     QSqlDatabase db = database();
     if (!db.isValid()) {
         return false;
@@ -498,39 +1105,460 @@ bool EventRepository::removeBySource(const QString& source) {
         return false;
     }
     query.bindValue(QStringLiteral(":source"), source);
+    QueryProfiler::Timing timing = profile("removeBySource", query);
     if (!query.exec()) {
         qWarning() << "[EventRepository] removeBySource exec failed" << query.lastError();
         return false;
     }
+    timing.finish(query.numRowsAffected());
     return query.numRowsAffected() > 0;
 }
 
+std::optional<qint64> EventRepository::changeSequence() const {
+    if (!m_sqlAvailable) {
+        return std::nullopt;
+    }
+    QSqlQuery* query = statement(Statement::ChangeBounds);
+    if (!query || !query->exec() || !query->next()) {
+        qWarning() << "[EventRepository] changeSequence failed" << (query ? query->lastError() : QSqlError());
+        return std::nullopt;
+    }
+    const qint64 newest = query->value(1).toLongLong();
+    query->finish();
+    return newest;
+}
+
+std::optional<EventChangeSet> EventRepository::changesSince(qint64 sequence) const {
+    if (!m_sqlAvailable) {
+        return std::nullopt;
+    }
+    QSqlQuery* bounds = statement(Statement::ChangeBounds);
+    if (!bounds || !bounds->exec() || !bounds->next()) {
+        qWarning() << "[EventRepository] changesSince bounds failed" << (bounds ? bounds->lastError() : QSqlError());
+        return std::nullopt;
+    }
+    const qint64 oldest = bounds->value(0).toLongLong();
+    const qint64 newest = bounds->value(1).toLongLong();
+    bounds->finish();
+
+    EventChangeSet changes;
+    changes.sequence = newest;
+    // Sequence numbers have no gaps, so anything before the oldest retained entry was
+    // pruned. A sequence beyond the newest entry belongs to a different database.
+    if (sequence < 0 || sequence > newest || (oldest > 0 && sequence < oldest - 1)) {
+        changes.complete = false;
+        return changes;
+    }
+    if (sequence == newest) {
+        return changes;
+    }
+
+    QSqlQuery* query = statement(Statement::ChangesSince);
+    if (!query) {
+        return std::nullopt;
+    }
+    query->bindValue(0, sequence);
+    QueryProfiler::Timing timing = profile("changesSince", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] changesSince exec failed" << query->lastError();
+        return std::nullopt;
+    }
+    // First and last kind per event decide how the caller sees it.
+    struct Span {
+        int first;
+        int last;
+    };
+    QHash<QString, Span> spans;
+    QStringList order;
+    qint64 rows = 0;
+    while (query->next()) {
+        ++rows;
+        changes.sequence = std::max(changes.sequence, query->value(0).toLongLong());
+        const QString id = query->value(1).toString();
+        const int kind = query->value(2).toInt();
+        auto it = spans.find(id);
+        if (it == spans.end()) {
+            spans.insert(id, {kind, kind});
+            order.append(id);
+        } else {
+            it->last = kind;
+        }
+    }
+    query->finish();
+    timing.finish(rows);
+
+    for (const auto& id : std::as_const(order)) {
+        const Span span = spans.value(id);
+        const bool existedBefore = span.first != event_schema::ChangeInserted;
+        const bool existsAfter = span.last != event_schema::ChangeRemoved;
+        if (existedBefore && existsAfter) {
+            changes.updated.append(id);
+        } else if (existsAfter) {
+            changes.inserted.append(id);
+        } else if (existedBefore) {
+            changes.removed.append(id);
+        }
+    }
+    return changes;
+}
+
+bool EventRepository::pruneChanges(qint64 sequence) {
+    if (!m_sqlAvailable || !onWriterThread("pruneChanges")) {
+        return false;
+    }
+    return pruneChangeLog(sequence) >= 0;
+}
+
+int EventRepository::pruneChangeLog(qint64 sequence) {
+    QSqlQuery* query = statement(Statement::PruneChanges);
+    if (!query) {
+        return -1;
+    }
+    query->bindValue(0, sequence);
+    QueryProfiler::Timing timing = profile("pruneChanges", *query);
+    if (!query->exec()) {
+        qWarning() << "[EventRepository] pruneChanges exec failed" << query->lastError();
+        return -1;
+    }
+    timing.finish(query->numRowsAffected());
+    return query->numRowsAffected();
+}
+
+std::optional<MaintenanceReport> EventRepository::runMaintenance(const MaintenancePolicy& policy) {
+    if (!m_sqlAvailable || !onWriterThread("runMaintenance")) {
+        return std::nullopt;
+    }
+    QSqlDatabase db = database();
+    if (!db.isValid()) {
+        return std::nullopt;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    const QString walPath = m_dbPath + QStringLiteral("-wal");
+
+    MaintenanceReport report;
+    report.ranAt = QDateTime::currentDateTimeUtc();
+    report.walBytesBefore = QFileInfo(walPath).size();
+    report.freePagesBefore = pragmaValue(db, QStringLiteral("freelist_count"));
+    report.pageCount = pragmaValue(db, QStringLiteral("page_count"));
+
+    if (const std::optional<qint64> newest = changeSequence(); newest && *newest > kChangeLogRetention) {
+        const int pruned = pruneChangeLog(*newest - kChangeLogRetention);
+        if (pruned > 0) {
+            report.actions.append(QStringLiteral("pruned %1 change log entries").arg(pruned));
+        }
+    }
+
+    const qint64 freePages = pragmaValue(db, QStringLiteral("freelist_count"));
+    if (freePages > 0 && freePages >= policy.vacuumMinFreePages
+        && static_cast<double>(freePages) >= policy.vacuumFreeRatio * static_cast<double>(report.pageCount)) {
+        m_connections.finishStatements();
+        if (pragmaValue(db, QStringLiteral("auto_vacuum")) == 2) {
+            if (execToEnd(db, QStringLiteral("PRAGMA incremental_vacuum(%1)").arg(policy.vacuumStepPages))) {
+                report.actions.append(QStringLiteral("incremental vacuum"));
+            }
+        } else if (execToEnd(db, QStringLiteral("PRAGMA auto_vacuum = INCREMENTAL"))
+                   && execToEnd(db, QStringLiteral("VACUUM"))) {
+            // Files created before incremental auto-vacuum need one full rewrite.
+            report.actions.append(QStringLiteral("vacuum (enabled incremental auto-vacuum)"));
+            // The rewrite may renumber the events rowids that events_fts is keyed by.
+            if (m_ftsAvailable) {
+                if (db.transaction() && event_schema::rebuildSearchIndex(db) && db.commit()) {
+                    report.actions.append(QStringLiteral("rebuilt search index"));
+                } else {
+                    qWarning() << "[EventRepository] Search index rebuild after VACUUM failed" << db.lastError();
+                    db.rollback();
+                }
+            }
+        }
+    }
+
+    if (execToEnd(db, QStringLiteral("PRAGMA optimize"))) {
+        report.actions.append(QStringLiteral("optimize"));
+    }
+
+    if (QFileInfo(walPath).size() >= policy.checkpointWalBytes) {
+        QSqlQuery checkpoint(db);
+        // Result row: busy, WAL frames, frames checkpointed. Busy means a reader kept
+        // an older snapshot open and the WAL could not be reset.
+        if (checkpoint.exec(QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)")) && checkpoint.next()) {
+            report.actions.append(checkpoint.value(0).toInt() == 0 ? QStringLiteral("checkpoint")
+                                                                    : QStringLiteral("checkpoint (busy)"));
+        } else {
+            qWarning() << "[EventRepository] wal_checkpoint failed" << checkpoint.lastError();
+        }
+    }
+
+    report.walBytesAfter = QFileInfo(walPath).size();
+    report.freePagesAfter = pragmaValue(db, QStringLiteral("freelist_count"));
+    report.durationMs = timer.elapsed();
+    recordMaintenance(report);
+    qInfo() << "[EventRepository] Maintenance:" << report.actions.join(QStringLiteral(", "))
+            << "wal" << report.walBytesBefore << "->" << report.walBytesAfter
+            << "free pages" << report.freePagesBefore << "->" << report.freePagesAfter
+            << "in" << report.durationMs << "ms";
+    return report;
+}
+
+void EventRepository::recordMaintenance(const MaintenanceReport& report) {
+    QSqlQuery query(database());
+    if (!query.prepare(QStringLiteral(
+            "INSERT INTO maintenance_log (ranAt, actions, walBytesBefore, walBytesAfter, freePagesBefore,"
+            " freePagesAfter, pageCount, durationMs) VALUES (?, ?, ?, ?, ?, ?, ?, ?)"))) {
+        qWarning() << "[EventRepository] maintenance log prepare failed" << query.lastError();
+        return;
+    }
+    query.bindValue(0, report.ranAt.toMSecsSinceEpoch());
+    query.bindValue(1, report.actions.join(QLatin1Char('\n')));
+    query.bindValue(2, report.walBytesBefore);
+    query.bindValue(3, report.walBytesAfter);
+    query.bindValue(4, report.freePagesBefore);
+    query.bindValue(5, report.freePagesAfter);
+    query.bindValue(6, report.pageCount);
+    query.bindValue(7, report.durationMs);
+    if (!query.exec()) {
+        qWarning() << "[EventRepository] maintenance log insert failed" << query.lastError();
+        return;
+    }
+    query.finish();
+    if (!query.exec(QStringLiteral("DELETE FROM maintenance_log WHERE id <= (SELECT MAX(id) FROM maintenance_log) - %1")
+                        .arg(kMaintenanceLogRetention))) {
+        qWarning() << "[EventRepository] maintenance log trim failed" << query.lastError();
+    }
+}
+
+QVector<MaintenanceReport> EventRepository::maintenanceHistory(int limit) const {
+    if (!m_sqlAvailable || limit <= 0) {
+        return {};
+    }
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.prepare(QStringLiteral(
+            "SELECT ranAt, actions, walBytesBefore, walBytesAfter, freePagesBefore, freePagesAfter, pageCount,"
+            " durationMs FROM maintenance_log ORDER BY id DESC LIMIT ?"))) {
+        qWarning() << "[EventRepository] maintenanceHistory prepare failed" << query.lastError();
+        return {};
+    }
+    query.bindValue(0, limit);
+    if (!query.exec()) {
+        qWarning() << "[EventRepository] maintenanceHistory exec failed" << query.lastError();
+        return {};
+    }
+    QVector<MaintenanceReport> history;
+    while (query.next()) {
+        MaintenanceReport report;
+        report.ranAt = QDateTime::fromMSecsSinceEpoch(query.value(0).toLongLong(), QTimeZone::utc());
+        report.actions = query.value(1).toString().split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+        report.walBytesBefore = query.value(2).toLongLong();
+        report.walBytesAfter = query.value(3).toLongLong();
+        report.freePagesBefore = query.value(4).toLongLong();
+        report.freePagesAfter = query.value(5).toLongLong();
+        report.pageCount = query.value(6).toLongLong();
+        report.durationMs = query.value(7).toLongLong();
+        history.append(report);
+    }
+    return history;
+}
+
+QStringList EventRepository::explainQueryPlan(const QString& sql) const {
+    if (!m_sqlAvailable) {
+        return {};
+    }
+    QSqlDatabase db = database();
+    if (!db.isValid()) {
+        return {};
+    }
+    QSqlQuery query(db);
+    if (!query.exec(QStringLiteral("EXPLAIN QUERY PLAN ") + sql)) {
+        qWarning() << "[EventRepository] explainQueryPlan failed" << query.lastError();
+        return {};
+    }
+    QStringList details;
+    while (query.next()) {
+        details.append(query.value(QStringLiteral("detail")).toString());
+    }
+    return details;
+}
+
+void EventRepository::setQueryProfiling(const std::optional<QueryProfiler::Options>& options) {
+    if (m_profiler) {
+        m_profiler->dumpSummary();
+    }
+    m_profiler = options ? std::make_unique<QueryProfiler>(*options) : nullptr;
+}
+
+QVector<QueryProfiler::Stats> EventRepository::queryStats() const {
+    return m_profiler ? m_profiler->stats() : QVector<QueryProfiler::Stats>();
+}
+
+QString EventRepository::queryProfileSummary() const {
+    return m_profiler ? m_profiler->summary() : QString();
+}
+
+QueryProfiler::Timing EventRepository::profile(const char* label, const QSqlQuery& query) const {
+    if (!m_profiler) {
+        return {};
+    }
+    return m_profiler->start(label, query, database());
+}
+
+QueryProfiler::Timing EventRepository::profileCommit(const char* label) const {
+    if (!m_profiler) {
+        return {};
+    }
+    return m_profiler->start(label, QStringLiteral("COMMIT"), QSqlDatabase());
+}
+
+void EventRepository::setStatementCacheEnabled(bool enabled) {
+    m_statementCacheEnabled = enabled;
+    clearStatementCache();
+}
+
+void EventRepository::clearStatementCache() {
+    m_connections.clearStatements();
+}
+
+QSqlQuery* EventRepository::statement(Statement which) const {
+    return m_connections.prepared(static_cast<int>(which), statementSql(which), m_statementCacheEnabled);
+}
+
+bool EventRepository::onWriterThread(const char* operation) const {
+    if (m_connections.isWriterThread()) {
+        return true;
+    }
+    qWarning() << "[EventRepository]" << operation << "must run on the thread that called initialize()";
+    return false;
+}
+
+QString EventRepository::statementSql(Statement which) {
+    switch (which) {
+    case Statement::Insert:
+        return QStringLiteral(
+            "INSERT INTO events (id, title, start, end, allDay, location, notes, tags, isExam, isDone, due, colorHint, priority,"
+            " categoryId, source, externalId, eventType, createdAt, updatedAt, startDay, tz)"
+            " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    case Statement::Update:
+        return QStringLiteral(
+            "UPDATE events SET title = ?, start = ?, end = ?, allDay = ?, location = ?, notes = ?, tags = ?, isExam = ?,"
+            " isDone = ?, due = ?, colorHint = ?, priority = ?, categoryId = ?, source = ?, externalId = ?, eventType = ?,"
+            " updatedAt = ?, startDay = ?, tz = ? WHERE id = ?");
+    case Statement::SetDone:
+        return QStringLiteral("UPDATE events SET isDone = ?, updatedAt = ? WHERE id = ?");
+    case Statement::Remove:
+        return QStringLiteral("DELETE FROM events WHERE id = ?");
+    case Statement::DeleteTags:
+        return QStringLiteral("DELETE FROM event_tags WHERE event_id = ?");
+    case Statement::InsertTag:
+        return QStringLiteral("INSERT OR IGNORE INTO event_tags (event_id, tag) VALUES (?, ?)");
+    case Statement::FindById:
+        return selectColumns(EventProjection::Full) + QStringLiteral(" FROM events WHERE id = ?");
+    case Statement::FindByExternalId:
+        return selectColumns(EventProjection::Full) + QStringLiteral(" FROM events WHERE source = ? AND externalId = ? LIMIT 1");
+    case Statement::FindBySource:
+        return selectColumns(EventProjection::Full) + QStringLiteral(" FROM events WHERE source = ? ORDER BY start ASC");
+    case Statement::LoadAll:
+    case Statement::LoadAllOpen:
+    case Statement::LoadAllSummary:
+    case Statement::LoadAllOpenSummary:
+    case Statement::LoadBetween:
+    case Statement::LoadBetweenOpen:
+    case Statement::LoadBetweenSummary:
+    case Statement::LoadBetweenOpenSummary: {
+        const bool range = which >= Statement::LoadBetween;
+        const int variant = static_cast<int>(which) - static_cast<int>(range ? Statement::LoadBetween : Statement::LoadAll);
+        const bool onlyOpen = variant & 1;
+        const EventProjection projection = (variant & 2) ? EventProjection::Summary : EventProjection::Full;
+        QString sql = selectColumns(projection) + QStringLiteral(" FROM events");
+        if (range) {
+            sql += QStringLiteral(" WHERE startDay BETWEEN ? AND ?");
+            if (onlyOpen) {
+                sql += QStringLiteral(" AND isDone = 0");
+            }
+            return sql + QStringLiteral(" ORDER BY startDay ASC, start ASC");
+        }
+        if (onlyOpen) {
+            sql += QStringLiteral(" WHERE isDone = 0");
+        }
+        return sql + QStringLiteral(" ORDER BY start ASC");
+    }
+    case Statement::OpenBetween:
+    case Statement::OpenBetweenSummary: {
+        const EventProjection projection = which == Statement::OpenBetweenSummary ? EventProjection::Summary
+                                                                                   : EventProjection::Full;
+        return selectColumns(projection)
+            + QStringLiteral(" FROM events WHERE isDone = 0 AND start >= ? AND start < ? ORDER BY start ASC");
+    }
+    case Statement::UpcomingExams:
+    case Statement::UpcomingExamsSummary: {
+        const EventProjection projection = which == Statement::UpcomingExamsSummary ? EventProjection::Summary
+                                                                                     : EventProjection::Full;
+        return selectColumns(projection)
+            + QStringLiteral(" FROM events WHERE isExam = 1 AND start >= ? ORDER BY start ASC LIMIT ?");
+    }
+    case Statement::Page:
+    case Statement::PageOpen:
+    case Statement::PageSummary:
+    case Statement::PageOpenSummary: {
+        const int variant = static_cast<int>(which) - static_cast<int>(Statement::Page);
+        const EventProjection projection = (variant & 2) ? EventProjection::Summary : EventProjection::Full;
+        QString sql = selectColumns(projection) + QStringLiteral(" FROM events WHERE (start, id) > (?, ?) AND start < ?");
+        if (variant & 1) {
+            sql += QStringLiteral(" AND isDone = 0");
+        }
+        return sql + QStringLiteral(" ORDER BY start ASC, id ASC LIMIT ?");
+    }
+    case Statement::ChangeBounds:
+        // Two subqueries so each is a single rowid lookup rather than one scan.
+        return QStringLiteral("SELECT (SELECT MIN(seq) FROM event_changes), (SELECT MAX(seq) FROM event_changes)");
+    case Statement::ChangesSince:
+        return QStringLiteral("SELECT seq, event_id, kind FROM event_changes WHERE seq > ? ORDER BY seq ASC");
+    case Statement::PruneChanges:
+        return QStringLiteral(
+            "DELETE FROM event_changes WHERE seq <= ? AND seq < (SELECT MAX(seq) FROM event_changes)");
+    case Statement::BeginItem:
+        return QStringLiteral("SAVEPOINT batch_item");
+    case Statement::ReleaseItem:
+        return QStringLiteral("RELEASE batch_item");
+    case Statement::RollbackItem:
+        return QStringLiteral("ROLLBACK TO batch_item");
+    case Statement::Count:
+        break;
+    }
+    return QString();
+}
+
+EventRepository::Statement EventRepository::variantOf(Statement base, bool onlyOpen, EventProjection projection) {
+    // Loader statements are laid out as {base, open, summary, open + summary}.
+    const int offset = (onlyOpen ? 1 : 0) + (projection == EventProjection::Summary ? 2 : 0);
+    return static_cast<Statement>(static_cast<int>(base) + offset);
+}
+
 QSqlDatabase EventRepository::database() const {
-    return QSqlDatabase::database(m_connectionName, false);
+    return m_connections.connection();
 }
 
-QVector<EventRecord> EventRepository::runQuery(QSqlQuery& query) const {
+QVector<EventRecord> EventRepository::runQuery(QSqlQuery& query, EventProjection projection) const {
     QVector<EventRecord> results;
     const QDate today = QDate::currentDate();
     while (query.next()) {
-        EventRecord record = recordFromQuery(query);
+        EventRecord record = recordFromQuery(query, projection);
         record.priority = computePriority(record, today);
-        results.append(record);
+        results.append(std::move(record));
     }
     return results;
 }
 
-EventRecord EventRepository::recordFromQuery(const QSqlQuery& query) {
+EventRecord EventRepository::recordFromQuery(const QSqlQuery& query, EventProjection projection) {
     EventRecord record;
-    record.id = query.value(QStringLiteral("id")).toString();
-    record.title = query.value(QStringLiteral("title")).toString();
-    record.start = fromIso(query.value(QStringLiteral("start")).toString());
-    record.end = fromIso(query.value(QStringLiteral("end")).toString());
-    record.allDay = query.value(QStringLiteral("allDay")).toInt() == 1;
-    record.location = query.value(QStringLiteral("location")).toString();
-    record.notes = query.value(QStringLiteral("notes")).toString();
-    const QString tagsJson = query.value(QStringLiteral("tags")).toString();
-    if (!tagsJson.isEmpty()) {
+    record.id = query.value(ColId).toString();
+    record.title = query.value(ColTitle).toString();
+    const QString tz = query.value(ColTz).toString();
+    record.start = event_schema::fromEpoch(query.value(ColStart), tz);
+    record.end = event_schema::fromEpoch(query.value(ColEnd), tz);
+    record.allDay = query.value(ColAllDay).toInt() == 1;
+    record.location = query.value(ColLocation).toString();
+    const QString tagsJson = query.value(ColTags).toString();
+    if (!tagsJson.isEmpty() && tagsJson != QLatin1String("[]")) {
         const QJsonDocument doc = QJsonDocument::fromJson(tagsJson.toUtf8());
         if (doc.isArray()) {
             const QJsonArray arr = doc.array();
@@ -539,186 +1567,404 @@ EventRecord EventRepository::recordFromQuery(const QSqlQuery& query) {
             }
         }
     }
-    record.isExam = query.value(QStringLiteral("isExam")).toInt() == 1;
-    record.isDone = query.value(QStringLiteral("isDone")).toInt() == 1;
-    record.due = fromIso(query.value(QStringLiteral("due")).toString());
-    record.colorHint = query.value(QStringLiteral("colorHint")).toString();
-    record.priority = query.value(QStringLiteral("priority")).toInt();
-    record.categoryId = query.value(QStringLiteral("categoryId")).toString();
-    record.source = query.value(QStringLiteral("source")).toString();
-    record.externalId = query.value(QStringLiteral("externalId")).toString();
-    record.eventType = query.value(QStringLiteral("eventType")).toString();
+    record.isExam = query.value(ColIsExam).toInt() == 1;
+    record.isDone = query.value(ColIsDone).toInt() == 1;
+    record.due = event_schema::fromEpoch(query.value(ColDue), tz);
+    record.colorHint = query.value(ColColorHint).toString();
+    record.priority = query.value(ColPriority).toInt();
+    record.categoryId = query.value(ColCategoryId).toString();
+    record.source = query.value(ColSource).toString();
+    record.externalId = query.value(ColExternalId).toString();
+    record.eventType = query.value(ColEventType).toString();
+    if (projection == EventProjection::Full) {
+        record.notes = query.value(ColNotes).toString();
+    }
     return record;
 }
 
 QVector<EventRecord> EventRepository::loadFromJson(bool onlyOpen) const {
-    const QJsonArray array = readJsonArray();
     QVector<EventRecord> records;
-    records.reserve(array.size());
     const QDate today = QDate::currentDate();
-    for (const auto& value : array) {
-        if (!value.isObject()) {
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+    records.reserve(m_jsonCache.byStart.size());
+    for (const auto& entry : std::as_const(m_jsonCache.byStart)) {
+        const EventRecord& cached = *m_jsonCache.byId.constFind(entry.second);
+        if (onlyOpen && cached.isDone) {
             continue;
         }
-        EventRecord record = recordFromJson(value.toObject());
-        if (onlyOpen && record.isDone) {
-            continue;
-        }
-        record.priority = computePriority(record, today);
-        records.append(record);
+        records.append(cached);
+        records.last().priority = computePriority(cached, today);
     }
-    std::sort(records.begin(), records.end(), [](const EventRecord& a, const EventRecord& b) {
-        return a.start < b.start;
-    });
     return records;
 }
 
 QVector<EventRecord> EventRepository::loadRangeFromJson(const QDate& start, const QDate& end, bool onlyOpen) const {
-    const QJsonArray array = readJsonArray();
     QVector<EventRecord> records;
     const QDate today = QDate::currentDate();
-    for (const auto& value : array) {
-        if (!value.isObject()) {
+    // The day test uses each event's own zone, so bisect with a day of slack on
+    // either side and filter exactly below.
+    const QPair<qint64, QString> from(QDateTime(start.addDays(-1), QTime(0, 0)).toMSecsSinceEpoch(), QString());
+    const qint64 until = QDateTime(end.addDays(2), QTime(0, 0)).toMSecsSinceEpoch();
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+    auto it = std::lower_bound(m_jsonCache.byStart.cbegin(), m_jsonCache.byStart.cend(), from);
+    for (; it != m_jsonCache.byStart.cend() && it->first < until; ++it) {
+        const EventRecord& cached = *m_jsonCache.byId.constFind(it->second);
+        const QDate d = cached.start.date();
+        if (d < start || d > end || (onlyOpen && cached.isDone)) {
             continue;
         }
-        EventRecord record = recordFromJson(value.toObject());
-        if (!record.start.isValid()) {
+        records.append(cached);
+        records.last().priority = computePriority(cached, today);
+    }
+    return records;
+}
+
+QVector<EventRecord> EventRepository::searchInJson(const QString& term, const QStringList& tagFilters,
+                                                   bool onlyOpen) const {
+    const QString needle = term.trimmed().toLower();
+    QVector<EventRecord> records;
+    const QDate today = QDate::currentDate();
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+    for (const auto& entry : std::as_const(m_jsonCache.byStart)) {
+        const EventRecord& cached = *m_jsonCache.byId.constFind(entry.second);
+        if (onlyOpen && cached.isDone) {
             continue;
         }
-        const QDate d = record.start.date();
-        if (d < start || d > end) {
+        const QString haystack = QStringList({cached.title.toLower(), cached.location.toLower(), cached.tags.join(" ").toLower()}).join(' ');
+        if (!needle.isEmpty() && !haystack.contains(needle)) {
             continue;
         }
-        if (onlyOpen && record.isDone) {
+        if (!tagFilters.isEmpty() && !matchesTags(cached, tagFilters, TagMatch::All)) {
             continue;
         }
-        record.priority = computePriority(record, today);
-        records.append(record);
+        records.append(cached);
+        records.last().priority = computePriority(cached, today);
     }
-    std::sort(records.begin(), records.end(), [](const EventRecord& a, const EventRecord& b) {
-        return a.start < b.start;
-    });
     return records;
 }
 
-QVector<EventRecord> EventRepository::searchInJson(const QString& term, bool onlyOpen) const {
-    const QString needle = term.trimmed().toLower();
+void EventRepository::refreshJsonCache() const {
+    const QFileInfo snapshot(data_file::storedPath(m_jsonPath));
+    const QFileInfo journal(m_journalPath);
+    const qint64 snapshotSize = snapshot.exists() ? snapshot.size() : -1;
+    const qint64 journalSize = journal.exists() ? journal.size() : -1;
+    if (m_jsonCache.loaded && snapshotSize == m_jsonCache.snapshotSize && journalSize == m_jsonCache.journalSize
+        && snapshot.lastModified() == m_jsonCache.snapshotModified
+        && journal.lastModified() == m_jsonCache.journalModified) {
+        return;
+    }
+
+    // Stamped with what was seen before reading, so a write that lands while
+    // reading triggers another reload on the next call.
+    JsonCache cache;
+    cache.loaded = true;
+    cache.snapshotSize = snapshotSize;
+    cache.snapshotModified = snapshot.lastModified();
+    cache.journalSize = journalSize;
+    cache.journalModified = journal.lastModified();
     const QJsonArray array = readJsonArray();
-    QVector<EventRecord> records;
-    const QDate today = QDate::currentDate();
+    cache.byId.reserve(array.size());
     for (const auto& value : array) {
         if (!value.isObject()) {
             continue;
         }
-        EventRecord record = recordFromJson(value.toObject());
-        if (onlyOpen && record.isDone) {
+        const EventRecord record = recordFromJson(value.toObject());
+        if (!record.source.isEmpty() && !record.externalId.isEmpty()) {
+            cache.idByExternalKey.insert(externalKey(record.source, record.externalId), record.id);
+        }
+        cache.byId.insert(record.id, record);
+    }
+    cache.byStart.reserve(cache.byId.size());
+    for (const auto& record : std::as_const(cache.byId)) {
+        cache.byStart.append({startKey(record.start), record.id});
+    }
+    std::sort(cache.byStart.begin(), cache.byStart.end());
+    m_jsonCache = std::move(cache);
+}
+
+void EventRepository::restampJsonCache() const {
+    const QFileInfo snapshot(data_file::storedPath(m_jsonPath));
+    const QFileInfo journal(m_journalPath);
+    m_jsonCache.snapshotSize = snapshot.exists() ? snapshot.size() : -1;
+    m_jsonCache.snapshotModified = snapshot.lastModified();
+    m_jsonCache.journalSize = journal.exists() ? journal.size() : -1;
+    m_jsonCache.journalModified = journal.lastModified();
+}
+
+void EventRepository::cachePut(JsonCache& cache, const EventRecord& record) {
+    cacheRemove(cache, record.id);
+    if (!record.source.isEmpty() && !record.externalId.isEmpty()) {
+        cache.idByExternalKey.insert(externalKey(record.source, record.externalId), record.id);
+    }
+    cache.byId.insert(record.id, record);
+    const QPair<qint64, QString> key(startKey(record.start), record.id);
+    cache.byStart.insert(std::lower_bound(cache.byStart.begin(), cache.byStart.end(), key), key);
+}
+
+void EventRepository::cacheRemove(JsonCache& cache, const QString& id) {
+    const auto it = cache.byId.find(id);
+    if (it == cache.byId.end()) {
+        return;
+    }
+    const EventRecord& record = it.value();
+    const auto external = cache.idByExternalKey.find(externalKey(record.source, record.externalId));
+    if (external != cache.idByExternalKey.end() && external.value() == id) {
+        cache.idByExternalKey.erase(external);
+    }
+    const QPair<qint64, QString> key(startKey(record.start), id);
+    const auto position = std::lower_bound(cache.byStart.begin(), cache.byStart.end(), key);
+    if (position != cache.byStart.end() && *position == key) {
+        cache.byStart.erase(position);
+    }
+    cache.byId.erase(it);
+}
+
+bool EventRepository::writeJsonArray(const QJsonArray& array) const {
+    // Replaced atomically: compaction relies on the old snapshot surviving a crash.
+    if (!data_file::write(m_jsonPath, QJsonDocument(array), QJsonDocument::Compact)) {
+        qWarning() << "[EventRepository] Unable to write JSON store" << m_jsonPath;
+        return false;
+    }
+    return true;
+}
+
+QJsonArray EventRepository::readJsonArray(bool* ok) const {
+    if (ok) {
+        *ok = true;
+    }
+    QJsonArray array;
+    if (data_file::exists(m_jsonPath)) {
+        const std::optional<QJsonDocument> doc = data_file::read(m_jsonPath);
+        if (!doc) {
+            qWarning() << "[EventRepository] Unable to read JSON store" << m_jsonPath;
+            if (ok) {
+                *ok = false;
+            }
+            return QJsonArray();
+        }
+        if (doc->isArray()) {
+            array = doc->array();
+        } else if (ok) {
+            *ok = false;
+        }
+    }
+
+    QFile journal(m_journalPath);
+    if (!journal.exists()) {
+        return array;
+    }
+    if (!journal.open(QIODevice::ReadOnly)) {
+        qWarning() << "[EventRepository] Unable to read JSON journal" << m_journalPath;
+        if (ok) {
+            *ok = false;
+        }
+        return array;
+    }
+    QHash<QString, int> indexById;
+    indexById.reserve(array.size());
+    for (int i = 0; i < array.size(); ++i) {
+        indexById.insert(array.at(i).toObject().value(QStringLiteral("id")).toString(), i);
+    }
+    int lineNumber = 0;
+    while (!journal.atEnd()) {
+        const QByteArray line = journal.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty()) {
             continue;
         }
-        const QString haystack = QStringList({record.title.toLower(), record.location.toLower(), record.tags.join(" ").toLower()}).join(' ');
-        if (!needle.isEmpty() && !haystack.contains(needle)) {
+        const QJsonDocument entry = QJsonDocument::fromJson(line);
+        if (!entry.isObject()) {
+            // A write cut short by a crash leaves at most one torn line.
+            qWarning() << "[EventRepository] Skipping unreadable journal line" << lineNumber;
             continue;
         }
-        record.priority = computePriority(record, today);
-        records.append(record);
+        applyJournalEntry(array, indexById, entry.object());
     }
-    std::sort(records.begin(), records.end(), [](const EventRecord& a, const EventRecord& b) {
-        return a.start < b.start;
-    });
-    return records;
+    if (indexById.size() == array.size()) {
+        return array;
+    }
+    QJsonArray kept;
+    for (const auto& value : std::as_const(array)) {
+        if (!value.isNull()) {
+            kept.append(value);
+        }
+    }
+    return kept;
 }
 
-bool EventRepository::writeJsonArray(const QJsonArray& array) const {
-    QFile file(m_jsonPath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        qWarning() << "[EventRepository] Unable to write JSON store" << m_jsonPath;
+bool EventRepository::appendJournal(const QJsonObject& entry) {
+    QFile file(m_journalPath);
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        qWarning() << "[EventRepository] Unable to open JSON journal" << m_journalPath;
+        return false;
+    }
+    QByteArray line = QJsonDocument(entry).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    // Start on a fresh line if a previous append was cut short.
+    const qint64 size = file.size();
+    if (size > 0 && file.seek(size - 1) && file.read(1) != "\n") {
+        line.prepend('\n');
+    }
+    if (file.write(line) != line.size() || !file.flush()) {
+        qWarning() << "[EventRepository] Unable to append to JSON journal" << m_journalPath;
         return false;
     }
-    file.write(QJsonDocument(array).toJson(QJsonDocument::Compact));
     file.close();
+    compactJournalIfLarge();
     return true;
 }
 
-QJsonArray EventRepository::readJsonArray() const {
-    QFile file(m_jsonPath);
-    if (!file.exists()) {
-        return QJsonArray();
+void EventRepository::compactJournalIfLarge() {
+    const qint64 journalBytes = QFileInfo(m_journalPath).size();
+    if (journalBytes > std::max(kJournalCompactMinBytes, QFileInfo(data_file::storedPath(m_jsonPath)).size())) {
+        compactJournal();
+    }
+}
+
+bool EventRepository::compactJsonJournal() {
+    if (m_sqlAvailable || m_journalPath.isEmpty()) {
+        return false;
+    }
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+    const bool compacted = compactJournal();
+    restampJsonCache();
+    return compacted;
+}
+
+bool EventRepository::compactJournal() {
+    if (!QFile::exists(m_journalPath)) {
+        return true;
     }
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "[EventRepository] Unable to read JSON store" << m_jsonPath;
-        return QJsonArray();
+    bool ok = false;
+    const QJsonArray array = readJsonArray(&ok);
+    if (!ok || !writeJsonArray(array)) {
+        qWarning() << "[EventRepository] JSON journal compaction skipped";
+        return false;
     }
-    const QByteArray data = file.readAll();
-    file.close();
-    const QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (!doc.isArray()) {
-        return QJsonArray();
+    // Replaying the journal over the new snapshot gives the same state, so a crash
+    // before the journal is removed loses nothing.
+    if (!QFile::remove(m_journalPath)) {
+        qWarning() << "[EventRepository] Unable to remove JSON journal" << m_journalPath;
+        return false;
     }
-    return doc.array();
+    return true;
 }
 
 bool EventRepository::insertJson(EventRecord& record) {
     if (record.id.isEmpty()) {
         record.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
     }
-    QJsonArray array = readJsonArray();
-    array.append(recordToJson(record));
-    return writeJsonArray(array);
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+    if (!appendJournal({{QStringLiteral("op"), QStringLiteral("put")}, {QStringLiteral("record"), recordToJson(record)}})) {
+        return false;
+    }
+    cachePut(m_jsonCache, record);
+    restampJsonCache();
+    return true;
 }
 
 bool EventRepository::setDoneJson(const QString& id, bool done) {
-    QJsonArray array = readJsonArray();
-    bool changed = false;
-    for (int i = 0; i < array.size(); ++i) {
-        QJsonObject obj = array.at(i).toObject();
-        if (obj.value(QStringLiteral("id")).toString() == id) {
-            obj.insert(QStringLiteral("isDone"), done);
-            array.replace(i, obj);
-            changed = true;
-            break;
-        }
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+    const auto it = m_jsonCache.byId.find(id);
+    if (it == m_jsonCache.byId.end()) {
+        return false;
     }
-    if (!changed) {
+    if (!appendJournal({{QStringLiteral("op"), QStringLiteral("done")},
+                        {QStringLiteral("id"), id},
+                        {QStringLiteral("isDone"), done}})) {
         return false;
     }
-    return writeJsonArray(array);
+    it->isDone = done;
+    restampJsonCache();
+    return true;
 }
 
 bool EventRepository::updateJson(const EventRecord& record) {
-    QJsonArray array = readJsonArray();
-    bool changed = false;
-    for (int i = 0; i < array.size(); ++i) {
-        QJsonObject obj = array.at(i).toObject();
-        if (obj.value(QStringLiteral("id")).toString() == record.id) {
-            array.replace(i, recordToJson(record));
-            changed = true;
-            break;
-        }
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+    if (!m_jsonCache.byId.contains(record.id)) {
+        return false;
     }
-    if (!changed) {
+    if (!appendJournal({{QStringLiteral("op"), QStringLiteral("put")}, {QStringLiteral("record"), recordToJson(record)}})) {
         return false;
     }
-    return writeJsonArray(array);
+    cachePut(m_jsonCache, record);
+    restampJsonCache();
+    return true;
 }
 
 bool EventRepository::removeJson(const QString& id) {
-    QJsonArray array = readJsonArray();
-    QJsonArray updated;
-    bool removed = false;
-    for (const auto& value : array) {
-        if (!value.isObject()) {
-            continue;
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+    if (!m_jsonCache.byId.contains(id)) {
+        return false;
+    }
+    if (!appendJournal({{QStringLiteral("op"), QStringLiteral("remove")}, {QStringLiteral("id"), id}})) {
+        return false;
+    }
+    cacheRemove(m_jsonCache, id);
+    restampJsonCache();
+    return true;
+}
+
+EventBatchResult EventRepository::applyBatchJson(QVector<EventRecord>& inserts,
+                                                 const QVector<EventRecord>& updates,
+                                                 const QStringList& removals) {
+    EventBatchResult result;
+    QMutexLocker locker(&m_jsonMutex);
+    refreshJsonCache();
+
+    // The cache is updated as the batch is built and reloaded if the append fails.
+    // One journal line for the whole batch, so a torn write drops it entirely.
+    QJsonArray ops;
+    result.updated.reserve(updates.size());
+    for (const auto& record : updates) {
+        const bool found = m_jsonCache.byId.contains(record.id);
+        if (found) {
+            ops.append(QJsonObject{{QStringLiteral("op"), QStringLiteral("put")},
+                                   {QStringLiteral("record"), recordToJson(record)}});
+            cachePut(m_jsonCache, record);
         }
-        const QJsonObject obj = value.toObject();
-        if (obj.value(QStringLiteral("id")).toString() == id) {
-            removed = true;
-            continue;
+        result.updated.append(found);
+    }
+
+    result.inserted.reserve(inserts.size());
+    for (auto& record : inserts) {
+        if (record.id.isEmpty()) {
+            record.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
         }
-        updated.append(obj);
+        ops.append(QJsonObject{{QStringLiteral("op"), QStringLiteral("put")},
+                               {QStringLiteral("record"), recordToJson(record)}});
+        cachePut(m_jsonCache, record);
+        result.inserted.append(true);
     }
-    if (!removed) {
-        return false;
+
+    result.removed.reserve(removals.size());
+    for (const auto& id : removals) {
+        const bool found = m_jsonCache.byId.contains(id);
+        if (found) {
+            ops.append(QJsonObject{{QStringLiteral("op"), QStringLiteral("remove")}, {QStringLiteral("id"), id}});
+            cacheRemove(m_jsonCache, id);
+        }
+        result.removed.append(found);
     }
-    return writeJsonArray(updated);
+
+    if (!ops.isEmpty() && !appendJournal({{QStringLiteral("op"), QStringLiteral("batch")}, {QStringLiteral("ops"), ops}})) {
+        m_jsonCache.loaded = false;
+        result.updated.fill(false);
+        result.inserted.fill(false);
+        result.removed.fill(false);
+        return result;
+    }
+    restampJsonCache();
+    result.committed = true;
+    return result;
 }
 
 QJsonObject EventRepository::recordToJson(const EventRecord& record) {
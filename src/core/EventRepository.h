@@ -1,59 +1,310 @@
 #pragma once
 
+#include "QueryProfiler.h"
+#include "SqliteConnectionPool.h"
+#include "StorageProfile.h"
 #include "models/EventModel.h"
 
 #include <QDate>
+#include <QDateTime>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QMutex>
+#include <QPair>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QString>
+#include <QStringList>
 #include <QVector>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
 
+// Column set fetched by loaders. Summary skips the notes text, which grid and list
+// views never show; use findById() to get the full record.
+enum class EventProjection {
+    Full,
+    Summary
+};
+
+// How findByTags() combines several tags.
+enum class TagMatch {
+    All,
+    Any
+};
+
+// Keyset position in (start, id) order. The default cursor lies before the first
+// event; at() positions it before the first event starting at or after a time.
+struct EventCursor {
+    qint64 start = std::numeric_limits<qint64>::min();
+    QString id;
+
+    static EventCursor at(const QDateTime& from) { return {from.toMSecsSinceEpoch(), QString()}; }
+};
+
+struct EventPage {
+    QVector<EventRecord> records;
+    EventCursor next;
+    bool hasMore = false;
+};
+
+// Per-item outcome of EventRepository::applyBatch(), index-aligned with the inputs.
+struct EventBatchResult {
+    QVector<bool> inserted;
+    QVector<bool> updated;
+    QVector<bool> removed;
+    bool committed = false;
+
+    int changedCount() const {
+        return static_cast<int>(inserted.count(true) + updated.count(true) + removed.count(true));
+    }
+};
+
+// Events changed after a change sequence number, collapsed per event: an event
+// inserted and then updated is reported once as inserted, one inserted and removed
+// again not at all.
+struct EventChangeSet {
+    qint64 sequence = 0; // newest change covered; pass it to the next changesSince()
+    QStringList inserted;
+    QStringList updated;
+    QStringList removed;
+    // False if log entries after the requested sequence were pruned or the database
+    // was replaced; the caller has to reload everything.
+    bool complete = true;
+
+    bool isEmpty() const { return inserted.isEmpty() && updated.isEmpty() && removed.isEmpty(); }
+};
+
+// Thresholds for EventRepository::runMaintenance(). Zero thresholds force every step.
+struct MaintenancePolicy {
+    qint64 checkpointWalBytes = 4 * 1024 * 1024;
+    int vacuumMinFreePages = 256;
+    double vacuumFreeRatio = 0.10; // of page_count
+    int vacuumStepPages = 2048;    // pages released per incremental run
+};
+
+// What one maintenance run measured and did; every run is also kept in maintenance_log.
+struct MaintenanceReport {
+    QDateTime ranAt;
+    QStringList actions;
+    qint64 walBytesBefore = 0;
+    qint64 walBytesAfter = 0;
+    qint64 freePagesBefore = 0;
+    qint64 freePagesAfter = 0;
+    qint64 pageCount = 0;
+    qint64 durationMs = 0;
+};
+
+// Reads may run on any thread once initialize() has returned: each thread gets its
+// own read-only WAL connection, so range queries and searches never wait for a write.
+// Writes must stay on the thread that called initialize(), which owns the only
+// writer connection.
 class EventRepository {
 public:
     EventRepository();
     ~EventRepository();
 
+    // Pragma profile for every connection; takes effect on the next initialize().
+    // Defaults to NOAH_PLANNER_STORAGE_PROFILE, else Balanced.
+    void setProfile(StorageProfile profile) { m_profile = profile; }
+    StorageProfile profile() const { return m_profile; }
+
     bool initialize(const QString& storageDir);
 
-    QVector<EventRecord> loadAll(bool onlyOpen) const;
-    QVector<EventRecord> loadBetween(const QDate& start, const QDate& end, bool onlyOpen) const;
+    QVector<EventRecord> loadAll(bool onlyOpen, EventProjection projection = EventProjection::Full) const;
+    QVector<EventRecord> loadBetween(const QDate& start, const QDate& end, bool onlyOpen,
+                                     EventProjection projection = EventProjection::Full) const;
+    // Open events starting in [from, to), ordered by start (idx_events_open_start).
+    QVector<EventRecord> openBetween(const QDateTime& from, const QDateTime& to,
+                                     EventProjection projection = EventProjection::Full) const;
+    // Exams starting on or after the beginning of from, soonest first (idx_events_exam_start).
+    QVector<EventRecord> upcomingExams(const QDate& from, int limit,
+                                       EventProjection projection = EventProjection::Full) const;
+    // Keyset pagination: up to pageSize events after the cursor that start before until
+    // (invalid = unbounded), ordered by (start, id). Each page is one index range scan,
+    // so memory is bounded by the page size rather than the table size.
+    std::optional<EventPage> fetchPage(const EventCursor& after, const QDateTime& until, int pageSize, bool onlyOpen,
+                                       EventProjection projection = EventProjection::Full) const;
+    // Streams pages through the consumer until the range is exhausted or the consumer
+    // returns false. Returns false if a page query failed.
+    bool forEachPage(const EventCursor& from, const QDateTime& until, int pageSize, bool onlyOpen,
+                     EventProjection projection,
+                     const std::function<bool(const QVector<EventRecord>&)>& consumer) const;
+    std::optional<EventRecord> findById(const QString& id) const;
+    // Records for the given ids in start order; unknown ids are skipped.
+    QVector<EventRecord> findByIds(const QStringList& ids, EventProjection projection = EventProjection::Full) const;
+    // Words prefixed with '#' are tag filters (all must match) resolved through
+    // event_tags; the remaining text is matched against the search index.
     QVector<EventRecord> search(const QString& term, bool onlyOpen) const;
+    QVector<EventRecord> findByTag(const QString& tag, bool onlyOpen,
+                                   EventProjection projection = EventProjection::Full) const;
+    QVector<EventRecord> findByTags(const QStringList& tags, TagMatch match, bool onlyOpen,
+                                    EventProjection projection = EventProjection::Full) const;
 
     bool insert(EventRecord& record);
     bool setDone(const QString& id, bool done);
     bool update(const EventRecord& record);
     bool remove(const QString& id);
+    // Applies updates, then inserts, then removals in a single transaction (one file
+    // rewrite in JSON mode). Inserted records receive their generated ids.
+    EventBatchResult applyBatch(QVector<EventRecord>& inserts,
+                                const QVector<EventRecord>& updates,
+                                const QStringList& removals);
 
     std::optional<EventRecord> findByExternalId(const QString& source, const QString& externalId) const;
     QVector<EventRecord> findBySource(const QString& source) const;
     bool removeBySource(const QString& source);
 
+    // Change log, SQLite only (nullopt in JSON mode). Triggers record every insert,
+    // update and delete, including those made by other processes on the same file.
+    std::optional<qint64> changeSequence() const;
+    std::optional<EventChangeSet> changesSince(qint64 sequence) const;
+    // Drops log entries up to and including sequence; the newest entry is always kept.
+    bool pruneChanges(qint64 sequence);
+
+    // Trims the change log, incrementally vacuums when free pages exceed the policy
+    // (converting older files to incremental auto-vacuum with one VACUUM), runs
+    // PRAGMA optimize and truncates a large WAL. Writer thread only; nullopt in JSON
+    // mode. maintenanceHistory() returns the newest runs first.
+    std::optional<MaintenanceReport> runMaintenance(const MaintenancePolicy& policy = MaintenancePolicy());
+    QVector<MaintenanceReport> maintenanceHistory(int limit) const;
+
+    // Closes the calling thread's read connection; QThreads release theirs when they
+    // finish, other threads should call this before exiting.
+    void releaseThreadConnection() { m_connections.releaseReader(); }
+    int readerConnectionCount() const { return m_connections.readerCount(); }
+
     bool isSqlAvailable() const { return m_sqlAvailable; }
     QString databasePath() const { return m_dbPath; }
     QString jsonFallbackPath() const { return m_jsonPath; }
+    // JSON fallback: mutations are appended to this JSON-lines journal and replayed
+    // over the events.json snapshot on load. compactJsonJournal() folds the journal
+    // into a new snapshot; it also runs on its own once the journal outgrows the
+    // snapshot.
+    QString jsonJournalPath() const { return m_journalPath; }
+    bool compactJsonJournal();
+
+    // Diagnostics: EXPLAIN QUERY PLAN detail rows for a statement on the calling thread's connection.
+    QStringList explainQueryPlan(const QString& sql) const;
+    // Prepared statements are compiled once per connection and reused; disabling the
+    // cache re-prepares on every call (used by benchmarks to measure the difference).
+    // Call while no reads are running on other threads.
+    void setStatementCacheEnabled(bool enabled);
+    bool statementCacheEnabled() const { return m_statementCacheEnabled; }
+
+    // Per-statement latency tracking with a slow-query log (see QueryProfiler). Off
+    // unless NOAH_PLANNER_SLOW_QUERY_MS is set when initialize() runs; nullopt turns
+    // it off again. Call while no statements are running.
+    void setQueryProfiling(const std::optional<QueryProfiler::Options>& options);
+    QVector<QueryProfiler::Stats> queryStats() const;
+    QString queryProfileSummary() const;
 
 private:
-    QString m_connectionName;
+    enum class Statement {
+        Insert,
+        Update,
+        SetDone,
+        Remove,
+        DeleteTags,
+        InsertTag,
+        FindById,
+        FindByExternalId,
+        FindBySource,
+        LoadAll,
+        LoadAllOpen,
+        LoadAllSummary,
+        LoadAllOpenSummary,
+        LoadBetween,
+        LoadBetweenOpen,
+        LoadBetweenSummary,
+        LoadBetweenOpenSummary,
+        OpenBetween,
+        OpenBetweenSummary,
+        UpcomingExams,
+        UpcomingExamsSummary,
+        Page,
+        PageOpen,
+        PageSummary,
+        PageOpenSummary,
+        ChangeBounds,
+        ChangesSince,
+        PruneChanges,
+        BeginItem,
+        ReleaseItem,
+        RollbackItem,
+        Count
+    };
+
     QString m_dbPath;
     QString m_jsonPath;
+    QString m_journalPath;
     bool m_sqlAvailable = false;
+    bool m_ftsAvailable = false;
+    bool m_statementCacheEnabled = true;
+    StorageProfile m_profile;
+    mutable SqliteConnectionPool m_connections;
+    std::unique_ptr<QueryProfiler> m_profiler;
 
     QSqlDatabase database() const;
-    QVector<EventRecord> runQuery(QSqlQuery& query) const;
-    static EventRecord recordFromQuery(const QSqlQuery& query);
+    QSqlQuery* statement(Statement which) const;
+    bool onWriterThread(const char* operation) const;
+    // Inactive timings when profiling is off.
+    QueryProfiler::Timing profile(const char* label, const QSqlQuery& query) const;
+    QueryProfiler::Timing profileCommit(const char* label) const;
+    int pruneChangeLog(qint64 sequence);
+    void recordMaintenance(const MaintenanceReport& report);
+    bool insertSql(EventRecord& record);
+    bool updateSql(const EventRecord& record);
+    bool removeSql(const QString& id);
+    bool writeTagsSql(const QString& id, const QStringList& tags);
+    bool inTransaction(const std::function<bool()>& work);
+    // Runs one batch item under a savepoint inside the open transaction, so a failed
+    // item leaves nothing behind (e.g. an event row without its event_tags rows).
+    bool inSavepoint(const std::function<bool()>& work);
+    void clearStatementCache();
+    static QString statementSql(Statement which);
+    static Statement variantOf(Statement base, bool onlyOpen, EventProjection projection);
+    QVector<EventRecord> runQuery(QSqlQuery& query, EventProjection projection) const;
+    static EventRecord recordFromQuery(const QSqlQuery& query, EventProjection projection);
 
     QVector<EventRecord> loadFromJson(bool onlyOpen) const;
     QVector<EventRecord> loadRangeFromJson(const QDate& start, const QDate& end, bool onlyOpen) const;
-    QVector<EventRecord> searchInJson(const QString& term, bool onlyOpen) const;
+    QVector<EventRecord> searchInJson(const QString& term, const QStringList& tagFilters, bool onlyOpen) const;
     bool writeJsonArray(const QJsonArray& array) const;
-    QJsonArray readJsonArray() const;
+    // Snapshot with the journal replayed; ok is false if either file was unreadable.
+    QJsonArray readJsonArray(bool* ok = nullptr) const;
+    bool appendJournal(const QJsonObject& entry);
+    void compactJournalIfLarge();
+    bool compactJournal();
+
+    // Parsed JSON fallback store. Loaded on first use and reloaded when the size or
+    // modification time of events.json or the journal no longer matches what this
+    // instance last read or wrote; own writes update it in place. Guarded by m_jsonMutex.
+    struct JsonCache {
+        bool loaded = false;
+        qint64 snapshotSize = -1;
+        QDateTime snapshotModified;
+        qint64 journalSize = -1;
+        QDateTime journalModified;
+        QHash<QString, EventRecord> byId;
+        QHash<QString, QString> idByExternalKey; // externalKey(source, externalId) -> id
+        QVector<QPair<qint64, QString>> byStart;  // (start ms, id), ascending
+    };
+    mutable QMutex m_jsonMutex;
+    mutable JsonCache m_jsonCache;
+    void refreshJsonCache() const;
+    void restampJsonCache() const;
+    static void cachePut(JsonCache& cache, const EventRecord& record);
+    static void cacheRemove(JsonCache& cache, const QString& id);
     bool insertJson(EventRecord& record);
     bool setDoneJson(const QString& id, bool done);
     bool updateJson(const EventRecord& record);
     bool removeJson(const QString& id);
+    EventBatchResult applyBatchJson(QVector<EventRecord>& inserts,
+                                    const QVector<EventRecord>& updates,
+                                    const QStringList& removals);
 
     static QJsonObject recordToJson(const EventRecord& record);
     static EventRecord recordFromJson(const QJsonObject& object);
@@ -0,0 +1,523 @@
+#include "EventSchema.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTimeZone>
+
+#include <utility>
+
+namespace event_schema {
+namespace {
+struct FoldPair {
+    const char* from;
+    const char* to;
+};
+
+// Remaining diacritics are handled by the unicode61 tokenizer (remove_diacritics 2).
+constexpr FoldPair kGermanFolds[] = {
+    {"ä", "ae"}, {"ö", "oe"}, {"ü", "ue"},
+    {"Ä", "Ae"}, {"Ö", "Oe"}, {"Ü", "Ue"},
+    {"ß", "ss"}, {"ẞ", "SS"},
+};
+
+// SQL counterpart of foldGerman(), used by the FTS triggers.
+QString foldGermanSql(const QString& expression) {
+    QString sql = expression;
+    for (const auto& pair : kGermanFolds) {
+        sql = QStringLiteral("replace(%1, '%2', '%3')").arg(sql, QString::fromUtf8(pair.from), QString::fromUtf8(pair.to));
+    }
+    return sql;
+}
+
+QTimeZone zoneFromTag(const QString& tag) {
+    // Zone lookups hit the tz database; imported calendars use a handful of ids, so
+    // resolve each once per thread.
+    thread_local QHash<QString, QTimeZone> cache;
+    const auto it = cache.constFind(tag);
+    if (it != cache.constEnd()) {
+        return it.value();
+    }
+    QTimeZone zone;
+    if (tag == QLatin1String("UTC")) {
+        zone = QTimeZone::utc();
+    } else {
+        bool isOffset = false;
+        const int offset = tag.toInt(&isOffset);
+        zone = isOffset ? QTimeZone(offset) : QTimeZone(tag.toUtf8());
+    }
+    cache.insert(tag, zone);
+    return zone;
+}
+
+bool execAll(QSqlDatabase& db, const QStringList& statements) {
+    for (const auto& statement : statements) {
+        QSqlQuery query(db);
+        if (!query.exec(statement)) {
+            qWarning() << "[EventSchema] Statement failed" << statement.left(80) << query.lastError();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool hasColumn(QSqlDatabase& db, const QString& table, const QString& column) {
+    QSqlQuery pragma(db);
+    if (!pragma.exec(QStringLiteral("PRAGMA table_info(%1)").arg(table))) {
+        return false;
+    }
+    while (pragma.next()) {
+        if (pragma.value(QStringLiteral("name")).toString().compare(column, Qt::CaseInsensitive) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QStringList columnNames(QSqlDatabase& db, const QString& table) {
+    QStringList names;
+    QSqlQuery pragma(db);
+    if (pragma.exec(QStringLiteral("PRAGMA table_info(%1)").arg(table))) {
+        while (pragma.next()) {
+            names.append(pragma.value(QStringLiteral("name")).toString());
+        }
+    }
+    return names;
+}
+
+bool addColumnIfMissing(QSqlDatabase& db, const QString& table, const QString& column, const QString& typeDefinition) {
+    if (hasColumn(db, table, column)) {
+        return true;
+    }
+    return execAll(db, {QStringLiteral("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, typeDefinition)});
+}
+
+// Moves the events matching condition into events_quarantine, with their stored
+// values unchanged plus the reason and time, instead of deleting them. Migrations
+// use it for rows the new schema cannot hold. Returns the number of rows moved, or
+// -1 on failure.
+int quarantineEvents(QSqlDatabase& db, const QString& condition, const QString& reason,
+                     const QVariantList& values = {}) {
+    if (!execAll(db, {QStringLiteral("CREATE TABLE IF NOT EXISTS events_quarantine AS"
+                                     " SELECT *, '' AS reason, 0 AS quarantinedAt FROM events WHERE 0")})) {
+        return -1;
+    }
+    QStringList columns = columnNames(db, QStringLiteral("events_quarantine"));
+    columns.removeAll(QStringLiteral("reason"));
+    columns.removeAll(QStringLiteral("quarantinedAt"));
+    const QString list = columns.join(QStringLiteral(", "));
+
+    QSqlQuery copy(db);
+    copy.prepare(QStringLiteral("INSERT INTO events_quarantine (%1, reason, quarantinedAt) SELECT %1, ?, ? FROM events WHERE %2")
+                     .arg(list, condition));
+    copy.addBindValue(reason);
+    copy.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    for (const QVariant& value : values) {
+        copy.addBindValue(value);
+    }
+    QSqlQuery remove(db);
+    remove.prepare(QStringLiteral("DELETE FROM events WHERE %1").arg(condition));
+    for (const QVariant& value : values) {
+        remove.addBindValue(value);
+    }
+    if (!copy.exec() || !remove.exec()) {
+        qWarning() << "[EventSchema] Unable to quarantine events" << copy.lastError() << remove.lastError();
+        return -1;
+    }
+    const int moved = remove.numRowsAffected();
+    if (moved > 0) {
+        qWarning() << "[EventSchema] Moved" << moved << "events to events_quarantine:" << reason;
+    }
+    return moved;
+}
+
+// Rewrites ISO-8601 text timestamps written by older versions as epoch milliseconds.
+// Text without an offset was written from local time, so the conversion has to go
+// through QDateTime rather than SQLite's date functions, which assume UTC. Rows whose
+// start cannot be parsed are quarantined with their original text; unparsable
+// optional times become NULL and created/updated fall back to the start.
+bool convertTimestampsToEpoch(QSqlDatabase& db) {
+    QSqlQuery select(db);
+    select.setForwardOnly(true);
+    if (!select.exec(QStringLiteral(
+            "SELECT rowid, start, end, due, createdAt, updatedAt FROM events WHERE typeof(start) = 'text'"))) {
+        qWarning() << "[EventSchema] Timestamp migration failed" << select.lastError();
+        return false;
+    }
+    QSqlQuery update(db);
+    update.prepare(QStringLiteral(
+        "UPDATE events SET start = ?, end = ?, due = ?, createdAt = ?, updatedAt = ?, tz = ?, startDay = ? WHERE rowid = ?"));
+    const auto textToEpoch = [](const QVariant& value, const QVariant& fallback) {
+        const QVariant epoch = epochValue(QDateTime::fromString(value.toString(), Qt::ISODate));
+        if (epoch.isNull() && !value.toString().isEmpty()) {
+            qWarning() << "[EventSchema] Unparsable timestamp" << value.toString() << "replaced by" << fallback;
+        }
+        return epoch.isNull() ? fallback : epoch;
+    };
+    int converted = 0;
+    QVariantList malformed;
+    while (select.next()) {
+        const QDateTime start = QDateTime::fromString(select.value(1).toString(), Qt::ISODate);
+        if (!start.isValid()) {
+            qWarning() << "[EventSchema] Event at rowid" << select.value(0).toLongLong() << "has unparsable start"
+                       << select.value(1).toString();
+            malformed.append(select.value(0));
+            continue;
+        }
+        const QVariant startEpoch = epochValue(start);
+        update.bindValue(0, startEpoch);
+        update.bindValue(1, textToEpoch(select.value(2), QVariant()));
+        update.bindValue(2, textToEpoch(select.value(3), QVariant()));
+        update.bindValue(3, textToEpoch(select.value(4), startEpoch));
+        update.bindValue(4, textToEpoch(select.value(5), startEpoch));
+        update.bindValue(5, timeZoneTag(start));
+        update.bindValue(6, startDayValue(start));
+        update.bindValue(7, select.value(0));
+        if (!update.exec()) {
+            qWarning() << "[EventSchema] Timestamp migration failed" << update.lastError();
+            return false;
+        }
+        ++converted;
+    }
+    select.finish();
+    if (converted > 0) {
+        qInfo() << "[EventSchema] Converted" << converted << "events to epoch timestamps";
+    }
+    for (const QVariant& rowid : std::as_const(malformed)) {
+        if (quarantineEvents(db, QStringLiteral("rowid = ?"), QStringLiteral("unparsable start time"), {rowid}) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Version 1: events table with epoch timestamps. Databases from before versioning
+// may lack the later columns or still hold text timestamps; both are brought up to
+// the current shape here.
+bool createEventsTable(QSqlDatabase& db) {
+    const QString events = QStringLiteral("events");
+    return execAll(db, {QStringLiteral(
+               "CREATE TABLE IF NOT EXISTS events ("
+               "id TEXT PRIMARY KEY NOT NULL,"
+               "title TEXT NOT NULL,"
+               "start INTEGER NOT NULL,"
+               "end INTEGER,"
+               "allDay INTEGER NOT NULL DEFAULT 0,"
+               "location TEXT,"
+               "notes TEXT,"
+               "tags TEXT,"
+               "isExam INTEGER NOT NULL DEFAULT 0,"
+               "isDone INTEGER NOT NULL DEFAULT 0,"
+               "due INTEGER,"
+               "colorHint TEXT,"
+               "priority INTEGER NOT NULL DEFAULT 0,"
+               "categoryId TEXT,"
+               "source TEXT,"
+               "externalId TEXT,"
+               "eventType TEXT,"
+               "createdAt INTEGER NOT NULL,"
+               "updatedAt INTEGER NOT NULL,"
+               "startDay INTEGER,"
+               "tz TEXT"
+               ")")})
+        && addColumnIfMissing(db, events, QStringLiteral("categoryId"), QStringLiteral("TEXT"))
+        && addColumnIfMissing(db, events, QStringLiteral("source"), QStringLiteral("TEXT"))
+        && addColumnIfMissing(db, events, QStringLiteral("externalId"), QStringLiteral("TEXT"))
+        && addColumnIfMissing(db, events, QStringLiteral("eventType"), QStringLiteral("TEXT"))
+        && addColumnIfMissing(db, events, QStringLiteral("startDay"), QStringLiteral("INTEGER"))
+        && addColumnIfMissing(db, events, QStringLiteral("tz"), QStringLiteral("TEXT"))
+        && convertTimestampsToEpoch(db)
+        && execAll(db, {
+               QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_start ON events(start)"),
+               QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_tags ON events(tags)"),
+               QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_source_external ON events(source, externalId)"),
+               QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_start_day ON events(startDay, start)"),
+           });
+}
+
+// Version 2: FTS5 index over the searchable text columns, kept in sync by triggers.
+// SQLite builds without FTS5 skip the index; search then falls back to a LIKE scan.
+bool createSearchIndex(QSqlDatabase& db) {
+    if (hasTable(db, QStringLiteral("events_fts"))) {
+        return true;
+    }
+    QSqlQuery create(db);
+    if (!create.exec(QStringLiteral("CREATE VIRTUAL TABLE events_fts USING fts5("
+                                    "title, location, notes, tags, tokenize = 'unicode61 remove_diacritics 2')"))) {
+        qInfo() << "[EventSchema] FTS5 unavailable, skipping search index" << create.lastError().text();
+        return true;
+    }
+
+    const QString fts = QStringLiteral("%1, %2, %3, %4");
+    const QString newValues = fts.arg(foldGermanSql(QStringLiteral("new.title")),
+                                      foldGermanSql(QStringLiteral("new.location")),
+                                      foldGermanSql(QStringLiteral("new.notes")),
+                                      foldGermanSql(QStringLiteral("new.tags")));
+    return rebuildSearchIndex(db) && execAll(db, {
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS events_fts_ai AFTER INSERT ON events BEGIN "
+                       "INSERT INTO events_fts(rowid, title, location, notes, tags) VALUES (new.rowid, %1); END").arg(newValues),
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS events_fts_ad AFTER DELETE ON events BEGIN "
+                       "DELETE FROM events_fts WHERE rowid = old.rowid; END"),
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS events_fts_au AFTER UPDATE OF title, location, notes, tags ON events BEGIN "
+                       "DELETE FROM events_fts WHERE rowid = old.rowid; "
+                       "INSERT INTO events_fts(rowid, title, location, notes, tags) VALUES (new.rowid, %1); END").arg(newValues),
+    });
+}
+
+// Version 3: tags normalised into event_tags so "has tag X" is an index lookup
+// instead of a LIKE over the JSON column. The JSON column stays the source for
+// display (original spelling and order); idx_events_tags on it is dropped.
+bool createTagTable(QSqlDatabase& db) {
+    if (!execAll(db, {
+            QStringLiteral("CREATE TABLE IF NOT EXISTS event_tags ("
+                           "event_id TEXT NOT NULL,"
+                           "tag TEXT NOT NULL,"
+                           "PRIMARY KEY (event_id, tag)"
+                           ") WITHOUT ROWID"),
+            QStringLiteral("CREATE INDEX IF NOT EXISTS idx_event_tags_tag ON event_tags(tag)"),
+            QStringLiteral("CREATE TRIGGER IF NOT EXISTS event_tags_ad AFTER DELETE ON events BEGIN "
+                           "DELETE FROM event_tags WHERE event_id = old.id; END"),
+            QStringLiteral("DROP INDEX IF EXISTS idx_events_tags"),
+        })) {
+        return false;
+    }
+
+    QSqlQuery select(db);
+    select.setForwardOnly(true);
+    if (!select.exec(QStringLiteral("SELECT id, tags FROM events WHERE tags IS NOT NULL AND tags <> '' AND tags <> '[]'"))) {
+        qWarning() << "[EventSchema] Tag backfill failed" << select.lastError();
+        return false;
+    }
+    QSqlQuery insert(db);
+    insert.prepare(QStringLiteral("INSERT OR IGNORE INTO event_tags (event_id, tag) VALUES (?, ?)"));
+    while (select.next()) {
+        const QJsonArray tags = QJsonDocument::fromJson(select.value(1).toString().toUtf8()).array();
+        for (const auto& value : tags) {
+            const QString key = tagKey(value.toString());
+            if (key.isEmpty()) {
+                continue;
+            }
+            insert.bindValue(0, select.value(0));
+            insert.bindValue(1, key);
+            if (!insert.exec()) {
+                qWarning() << "[EventSchema] Tag backfill failed" << insert.lastError();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Version 4: purpose-built indexes for the open-only and sidebar queries; the open
+// index carries id as a tie-breaker for keyset pages (see version 5). External
+// ids become unique per source; empty ids are stored as NULL (which never collide,
+// and neither do rows without a source). Duplicates left by earlier imports keep
+// their most recent row in events; the older copies go to events_quarantine.
+bool createLookupIndexes(QSqlDatabase& db) {
+    QSqlQuery cleanup(db);
+    if (!cleanup.exec(QStringLiteral("UPDATE events SET externalId = NULL WHERE externalId = ''"))
+        || !cleanup.exec(QStringLiteral("UPDATE events SET source = NULL WHERE source = ''"))) {
+        qWarning() << "[EventSchema] External id cleanup failed" << cleanup.lastError();
+        return false;
+    }
+    const QString olderDuplicates = QStringLiteral(
+        "source IS NOT NULL AND externalId IS NOT NULL AND rowid NOT IN"
+        " (SELECT MAX(rowid) FROM events WHERE source IS NOT NULL AND externalId IS NOT NULL GROUP BY source, externalId)");
+    if (quarantineEvents(db, olderDuplicates, QStringLiteral("duplicate (source, externalId)")) < 0) {
+        return false;
+    }
+    return execAll(db, {
+        QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_open_start ON events(start, id) WHERE isDone = 0"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_exam_start ON events(isExam, start)"),
+        QStringLiteral("CREATE UNIQUE INDEX IF NOT EXISTS idx_events_source_external_id ON events(source, externalId)"),
+        QStringLiteral("DROP INDEX IF EXISTS idx_events_source_external"),
+    });
+}
+
+// Version 5: start-ordered indexes carry id as a tie-breaker so keyset pages over
+// (start, id) are plain index range scans without a sort step.
+bool createKeysetIndexes(QSqlDatabase& db) {
+    return execAll(db, {
+        QStringLiteral("CREATE INDEX IF NOT EXISTS idx_events_start_id ON events(start, id)"),
+        QStringLiteral("DROP INDEX IF EXISTS idx_events_start"),
+    });
+}
+
+// Version 6: change log for incremental reloads. AUTOINCREMENT keeps sequence
+// numbers increasing even after old entries are pruned. Renaming an id is logged as
+// removal of the old id plus insertion of the new one.
+bool createChangeLog(QSqlDatabase& db) {
+    return execAll(db, {
+        QStringLiteral("CREATE TABLE IF NOT EXISTS event_changes ("
+                       "seq INTEGER PRIMARY KEY AUTOINCREMENT, event_id TEXT NOT NULL, kind INTEGER NOT NULL)"),
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS event_changes_ai AFTER INSERT ON events BEGIN"
+                       " INSERT INTO event_changes (event_id, kind) VALUES (new.id, %1); END")
+            .arg(ChangeInserted),
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS event_changes_au AFTER UPDATE ON events WHEN old.id = new.id BEGIN"
+                       " INSERT INTO event_changes (event_id, kind) VALUES (new.id, %1); END")
+            .arg(ChangeUpdated),
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS event_changes_au_id AFTER UPDATE OF id ON events"
+                       " WHEN old.id <> new.id BEGIN"
+                       " INSERT INTO event_changes (event_id, kind) VALUES (old.id, %1);"
+                       " INSERT INTO event_changes (event_id, kind) VALUES (new.id, %2); END")
+            .arg(ChangeRemoved)
+            .arg(ChangeInserted),
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS event_changes_ad AFTER DELETE ON events BEGIN"
+                       " INSERT INTO event_changes (event_id, kind) VALUES (old.id, %1); END")
+            .arg(ChangeRemoved),
+    });
+}
+
+// Version 7: history of background maintenance runs.
+bool createMaintenanceLog(QSqlDatabase& db) {
+    return execAll(db, {
+        QStringLiteral("CREATE TABLE IF NOT EXISTS maintenance_log ("
+                       "id INTEGER PRIMARY KEY, ranAt INTEGER NOT NULL, actions TEXT NOT NULL,"
+                       " walBytesBefore INTEGER, walBytesAfter INTEGER, freePagesBefore INTEGER,"
+                       " freePagesAfter INTEGER, pageCount INTEGER, durationMs INTEGER)"),
+    });
+}
+
+bool setVersion(QSqlDatabase& db, int version) {
+    // PRAGMA does not accept bound parameters.
+    return execAll(db, {QStringLiteral("PRAGMA user_version = %1").arg(version)});
+}
+} // namespace
+
+const QVector<Migration>& migrations() {
+    static const QVector<Migration> steps = {
+        {1, "events table with epoch timestamps", createEventsTable},
+        {2, "full-text search index", createSearchIndex},
+        {3, "normalized event tags", createTagTable},
+        {4, "open, exam and external id indexes", createLookupIndexes},
+        {5, "keyset paging indexes", createKeysetIndexes},
+        {6, "event change log", createChangeLog},
+        {7, "maintenance log", createMaintenanceLog},
+    };
+    return steps;
+}
+
+int latestVersion() {
+    return migrations().isEmpty() ? 0 : migrations().last().version;
+}
+
+int currentVersion(QSqlDatabase& db) {
+    QSqlQuery query(db);
+    if (!query.exec(QStringLiteral("PRAGMA user_version")) || !query.next()) {
+        return 0;
+    }
+    return query.value(0).toInt();
+}
+
+bool migrate(QSqlDatabase& db) {
+    const int current = currentVersion(db);
+    for (const auto& step : migrations()) {
+        if (step.version <= current) {
+            continue;
+        }
+        if (!db.transaction()) {
+            qWarning() << "[EventSchema] Unable to start migration" << step.version << db.lastError();
+            return false;
+        }
+        if (!step.apply(db) || !setVersion(db, step.version) || !db.commit()) {
+            qWarning() << "[EventSchema] Migration" << step.version << "failed:" << step.description;
+            db.rollback();
+            return false;
+        }
+        qInfo() << "[EventSchema] Applied migration" << step.version << step.description;
+    }
+    return true;
+}
+
+void prepareNewDatabase(QSqlDatabase& db) {
+    QSqlQuery query(db);
+    if (!query.exec(QStringLiteral("PRAGMA page_count")) || !query.next() || query.value(0).toLongLong() > 0) {
+        return;
+    }
+    query.finish();
+    if (!query.exec(QStringLiteral("PRAGMA auto_vacuum = INCREMENTAL"))) {
+        qWarning() << "[EventSchema] Unable to enable incremental auto-vacuum" << query.lastError();
+    }
+}
+
+bool rebuildSearchIndex(QSqlDatabase& db) {
+    if (!hasTable(db, QStringLiteral("events_fts"))) {
+        return true;
+    }
+    const QString rowValues = QStringLiteral("%1, %2, %3, %4").arg(foldGermanSql(QStringLiteral("title")),
+                                                                   foldGermanSql(QStringLiteral("location")),
+                                                                   foldGermanSql(QStringLiteral("notes")),
+                                                                   foldGermanSql(QStringLiteral("tags")));
+    return execAll(db, {
+        QStringLiteral("DELETE FROM events_fts"),
+        QStringLiteral("INSERT INTO events_fts(rowid, title, location, notes, tags) SELECT rowid, %1 FROM events").arg(rowValues),
+    });
+}
+
+bool hasTable(QSqlDatabase& db, const QString& name) {
+    QSqlQuery probe(db);
+    probe.prepare(QStringLiteral("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?"));
+    probe.bindValue(0, name);
+    return probe.exec() && probe.next();
+}
+
+QVariant epochValue(const QDateTime& dt) {
+    if (!dt.isValid()) {
+        return QVariant();
+    }
+    return dt.toMSecsSinceEpoch();
+}
+
+QVariant timeZoneTag(const QDateTime& dt) {
+    switch (dt.timeSpec()) {
+    case Qt::UTC:
+        return QStringLiteral("UTC");
+    case Qt::OffsetFromUTC:
+        return QString::number(dt.offsetFromUtc());
+    case Qt::TimeZone:
+        return QString::fromUtf8(dt.timeZone().id());
+    case Qt::LocalTime:
+    default:
+        return QVariant();
+    }
+}
+
+QDateTime fromEpoch(const QVariant& value, const QString& tag) {
+    if (value.isNull()) {
+        return QDateTime();
+    }
+    const qint64 msecs = value.toLongLong();
+    if (tag.isEmpty()) {
+        return QDateTime::fromMSecsSinceEpoch(msecs);
+    }
+    const QTimeZone zone = zoneFromTag(tag);
+    if (!zone.isValid()) {
+        return QDateTime::fromMSecsSinceEpoch(msecs);
+    }
+    return QDateTime::fromMSecsSinceEpoch(msecs, zone);
+}
+
+QVariant startDayValue(const QDateTime& start) {
+    if (!start.isValid()) {
+        return QVariant();
+    }
+    return start.date().toJulianDay();
+}
+
+QString foldGerman(const QString& text) {
+    QString folded = text;
+    for (const auto& pair : kGermanFolds) {
+        folded.replace(QString::fromUtf8(pair.from), QString::fromUtf8(pair.to));
+    }
+    return folded;
+}
+
+QString tagKey(const QString& tag) {
+    return foldGerman(tag.trimmed()).toLower();
+}
+
+} // namespace event_schema
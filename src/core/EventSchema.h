@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+// Schema and storage encoding of the events database. Every schema change is a
+// numbered migration step; PRAGMA user_version records the last step applied, so a
+// database that is already current is opened without touching the schema.
+namespace event_schema {
+
+struct Migration {
+    int version;
+    const char* description;
+    bool (*apply)(QSqlDatabase& db);
+};
+
+// Registered steps in ascending version order. New tables, columns and indexes go
+// here as a new step; existing steps must not change once released.
+const QVector<Migration>& migrations();
+int latestVersion();
+
+int currentVersion(QSqlDatabase& db);
+// Applies every step newer than the stored version, each in its own transaction
+// together with the user_version bump. Returns false if a step failed; steps
+// committed before the failure stay applied.
+bool migrate(QSqlDatabase& db);
+
+bool hasTable(QSqlDatabase& db, const QString& name);
+
+// Refills events_fts from events. The index is keyed by the events rowid, which a
+// full VACUUM may renumber (events has a TEXT primary key), so it is rebuilt after
+// one. No-op on builds without FTS5.
+bool rebuildSearchIndex(QSqlDatabase& db);
+
+// Settings that only take effect on an empty file: incremental auto-vacuum has to
+// be chosen before the first page is written (and before WAL is enabled). Existing
+// files are converted by EventRepository::runMaintenance() once fragmented.
+void prepareNewDatabase(QSqlDatabase& db);
+
+// Values of event_changes.kind. Triggers on events append one row per inserted,
+// updated or deleted event, whichever process made the change.
+enum ChangeKind {
+    ChangeInserted = 0,
+    ChangeUpdated = 1,
+    ChangeRemoved = 2
+};
+
+// Timestamps are stored as UTC epoch milliseconds. The zone of the start time is kept
+// in the tz column so reads can restore the original QDateTime without parsing text:
+// NULL = local time, "UTC", a UTC offset in seconds, or an IANA zone id.
+QVariant epochValue(const QDateTime& dt);
+QVariant timeZoneTag(const QDateTime& dt);
+QDateTime fromEpoch(const QVariant& value, const QString& tag);
+
+// Calendar day of the event start as stored (Julian day number). Range lookups
+// compare against this column so SQLite can walk idx_events_start_day instead of
+// evaluating date(start) for every row.
+QVariant startDayValue(const QDateTime& start);
+
+// German umlauts and sharp s are indexed in their transcribed form so that
+// "Übung", "uebung" and "übung" all hit the same token. Search terms go through
+// the same folding before they are matched.
+QString foldGerman(const QString& text);
+
+// Key stored in event_tags: folded and lower-cased, so "#Prüfung" and "#pruefung"
+// select the same events.
+QString tagKey(const QString& tag);
+
+} // namespace event_schema
@@ -1,4 +1,5 @@
 #include "FocusSessionRepository.h"
+#include "DataFile.h"
 
 #include <QDir>
 #include <QFile>
@@ -123,22 +124,15 @@ void FocusSessionRepository::ensureLoaded() const {
     m_cache.clear();
 
     const QString path = sessionsPath();
-    QFile file(path);
-    if (!file.exists()) {
+    if (!data_file::exists(path)) {
         return;
     }
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "[FocusSessionRepository] Cannot open" << path << file.errorString();
+    const std::optional<QJsonDocument> doc = data_file::read(path);
+    if (!doc || !doc->isArray()) {
         return;
     }
 
-    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    file.close();
-    if (!doc.isArray()) {
-        return;
-    }
-
-    const QJsonArray array = doc.array();
+    const QJsonArray array = doc->array();
     m_cache.reserve(array.size());
     for (const QJsonValue& value : array) {
         if (!value.isObject()) {
@@ -191,15 +185,7 @@ void FocusSessionRepository::saveSessions(const QVector<FocusSession>& sessions)
             array.append(session.toJson());
         }
     }
-    const QString path = sessionsPath();
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        qWarning() << "[FocusSessionRepository] Cannot save sessions" << path << file.errorString();
-        return;
-    }
-    QJsonDocument doc(array);
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    data_file::writeLater(sessionsPath(), QJsonDocument(array));
 }
 
 void FocusSessionRepository::saveState() const {
@@ -314,7 +314,8 @@ void IcsImportService::handleReply(QNetworkReply* reply) {
         }
     }
 
-    bool changed = false;
+    QVector<EventRecord> inserts;
+    QVector<EventRecord> updates;
     for (const auto& input : parsed) {
         EventRecord record = buildRecord(input);
         if (!record.start.isValid()) {
@@ -331,23 +332,39 @@ void IcsImportService::handleReply(QNetworkReply* reply) {
             if (!it->categoryId.isEmpty()) {
                 record.categoryId = it->categoryId;
             }
-            if (!m_repository->update(record)) {
-                qWarning() << "[IcsImportService] Failed to update event" << record.id;
-            } else {
-                changed = true;
-            }
+            updates.append(record);
             existing.erase(it);
         } else {
-            if (m_repository && m_repository->insert(record)) {
-                changed = true;
-            }
+            inserts.append(record);
         }
     }
 
+    QStringList removals;
+    removals.reserve(existing.size());
     for (auto it = existing.cbegin(); it != existing.cend(); ++it) {
-        if (m_repository && m_repository->remove(it->id)) {
-            changed = true;
+        removals.append(it->id);
+    }
+
+    bool changed = false;
+    if (m_repository) {
+        const EventBatchResult result = m_repository->applyBatch(inserts, updates, removals);
+        // Failed items are rolled back individually; the rest of the sync is kept.
+        for (int i = 0; i < result.updated.size(); ++i) {
+            if (!result.updated.at(i)) {
+                qWarning() << "[IcsImportService] Failed to update event" << updates.at(i).id;
+            }
+        }
+        for (int i = 0; i < result.inserted.size(); ++i) {
+            if (!result.inserted.at(i)) {
+                qWarning() << "[IcsImportService] Failed to insert event" << inserts.at(i).externalId;
+            }
+        }
+        for (int i = 0; i < result.removed.size(); ++i) {
+            if (!result.removed.at(i)) {
+                qWarning() << "[IcsImportService] Failed to remove event" << removals.at(i);
+            }
         }
+        changed = result.changedCount() > 0;
     }
 
     if (changed) {
@@ -0,0 +1,78 @@
+#include "PlannerConfig.h"
+
+#include <QDebug>
+#include <QJsonArray>
+
+#include <algorithm>
+#include <iterator>
+
+PlannerConfig PlannerConfig::fromJson(const QJsonObject& json) {
+    PlannerConfig config;
+
+    const auto capacity = json.value("daily_capacity_min").toObject();
+    for (int weekday = 0; weekday < 7; ++weekday) {
+        config.dailyCapacityMin[weekday] = std::max(0, capacity.value(QString::number(weekday)).toInt(0));
+    }
+
+    for (const auto& value : json.value("breaks").toArray()) {
+        const auto parts = value.toString().split("..");
+        const QDate start = parts.size() == 2 ? QDate::fromString(parts.at(0), Qt::ISODate) : QDate();
+        const QDate end = parts.size() == 2 ? QDate::fromString(parts.at(1), Qt::ISODate) : QDate();
+        if (!start.isValid() || !end.isValid() || end < start) {
+            qWarning() << "[PlannerConfig] Ignoring invalid break:" << value.toString();
+            continue;
+        }
+        config.breaks.append({start, end});
+    }
+    std::sort(config.breaks.begin(), config.breaks.end(),
+              [](const Break& a, const Break& b) { return a.start < b.start; });
+    QVector<Break> merged;
+    for (const Break& window : config.breaks) {
+        if (!merged.isEmpty() && window.start <= merged.last().end.addDays(1)) {
+            merged.last().end = std::max(merged.last().end, window.end);
+        } else {
+            merged.append(window);
+        }
+    }
+    config.breaks = merged;
+
+    const auto boostDays = json.value("exam_boost_days").toArray();
+    const auto boostFactors = json.value("exam_boost_factors").toArray();
+    if (boostDays.size() != boostFactors.size()) {
+        qWarning() << "[PlannerConfig] exam_boost_days and exam_boost_factors differ in length;"
+                   << "using the first" << std::min(boostDays.size(), boostFactors.size()) << "entries";
+    }
+    for (int i = 0; i < boostDays.size() && i < boostFactors.size(); ++i) {
+        config.examBoosts.append({boostDays.at(i).toInt(), boostFactors.at(i).toDouble(1.15)});
+    }
+
+    const auto levels = json.value("level_factor").toObject();
+    for (auto it = levels.begin(); it != levels.end(); ++it) {
+        config.levelFactor.insert(it.key(), it.value().toDouble(1.0));
+    }
+
+    config.maxSlots = std::max(0, json.value("max_slots").toInt(3));
+    config.slotMin = json.value("slot_min").toInt(20);
+    config.slotMax = json.value("slot_max").toInt(40);
+    if (config.slotMin <= 0 || config.slotMax < config.slotMin) {
+        qWarning() << "[PlannerConfig] Invalid slot range" << config.slotMin << ".." << config.slotMax
+                   << "- using 20..40";
+        config.slotMin = 20;
+        config.slotMax = 40;
+    }
+    return config;
+}
+
+int PlannerConfig::capacityFor(const QDate& date) const {
+    if (!date.isValid()) {
+        return 0;
+    }
+    return dailyCapacityMin[date.dayOfWeek() - 1];
+}
+
+bool PlannerConfig::isBreak(const QDate& date) const {
+    // The last window starting on or before date is the only one that can contain it.
+    const auto after = std::upper_bound(breaks.cbegin(), breaks.cend(), date,
+                                        [](const QDate& d, const Break& window) { return d < window.start; });
+    return after != breaks.cbegin() && date <= std::prev(after)->end;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+#include <array>
+
+// config.json compiled into the form day planning needs, so generating a day does
+// not touch JSON. Built once per load; entries that cannot be used are dropped with
+// a warning instead of being re-checked for every date.
+struct PlannerConfig {
+    struct Break {
+        QDate start; // inclusive
+        QDate end;   // inclusive
+    };
+
+    struct ExamBoost {
+        int daysBefore = 0;
+        double factor = 1.0;
+    };
+
+    std::array<int, 7> dailyCapacityMin{}; // Monday = 0, never negative
+    QVector<Break> breaks;                 // sorted by start, overlapping windows merged
+    QVector<ExamBoost> examBoosts;         // config order; equal days multiply
+    QHash<QString, double> levelFactor;
+    int maxSlots = 3;
+    int slotMin = 20;
+    int slotMax = 40;
+
+    static PlannerConfig fromJson(const QJsonObject& json);
+
+    int capacityFor(const QDate& date) const;
+    // Binary search over breaks.
+    bool isBreak(const QDate& date) const;
+    double levelFactorFor(const QString& level) const { return levelFactor.value(level, 1.0); }
+};
@@ -1,4 +1,5 @@
 #include "PlannerService.h"
+#include "DataFile.h"
 
 #include <QCoreApplication>
 #include <QDir>
@@ -7,6 +8,7 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QStandardPaths>
+#include <QtConcurrent>
 #include <QtMath>
 #include <algorithm>
 #include <optional>
@@ -43,19 +45,11 @@ QString locateSeedFile(const QString& fileName) {
 }
 
 bool seedHasContent(const QString& path, const QString& name) {
-    QFile file(path);
-    if (!file.exists()) {
+    const std::optional<QJsonDocument> doc = data_file::read(path);
+    if (!doc || !doc->isObject()) {
         return false;
     }
-    if (!file.open(QIODevice::ReadOnly)) {
-        return false;
-    }
-
-    const auto doc = QJsonDocument::fromJson(file.readAll());
-    if (!doc.isObject()) {
-        return false;
-    }
-    const QJsonObject obj = doc.object();
+    const QJsonObject obj = doc->object();
 
     if (name == QLatin1String("subjects.json")) {
         const auto subjects = obj.value(QStringLiteral("subjects")).toArray();
@@ -77,30 +71,22 @@ bool seedHasContent(const QString& path, const QString& name) {
     return false;
 }
 
+// JSON or CBOR, see DataFile.h.
 QJsonObject readJson(const QString& path) {
-    QFile f(path);
-    if (!f.open(QIODevice::ReadOnly)) {
-        qWarning() << "[PlannerService] Failed to open file for reading:" << path << f.errorString();
+    if (!data_file::exists(path)) {
+        qWarning() << "[PlannerService] Failed to open file for reading:" << path;
         return {};
     }
-    const QByteArray data = f.readAll();
-    const auto doc = QJsonDocument::fromJson(data);
-    if (doc.isNull()) {
-        qWarning() << "[PlannerService] Failed to parse JSON from:" << path;
+    const std::optional<QJsonDocument> doc = data_file::read(path);
+    if (!doc) {
+        qWarning() << "[PlannerService] Failed to read:" << path;
         return {};
     }
-    return doc.object();
+    return doc->object();
 }
 
 void writeJson(const QString& path, const QJsonObject& obj) {
-    QFile f(path);
-    if (!f.open(QIODevice::WriteOnly)) {
-        qWarning() << "[PlannerService] Failed to open file for writing:" << path << f.errorString();
-        return;
-    }
-    const QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Indented);
-    const qint64 written = f.write(data);
-    if (written != data.size()) {
+    if (!data_file::write(path, QJsonDocument(obj))) {
         qWarning() << "[PlannerService] Incomplete write to:" << path;
     }
 }
@@ -117,6 +103,16 @@ QString appDataDir() {
 }
 
 QString iso(const QDate& date) { return date.toString(Qt::ISODate); }
+
+// Below this many days the thread pool costs more than it saves.
+constexpr int kParallelRangeMinDays = 32;
+// About three school years of plans; the cache starts over beyond that.
+constexpr int kPlanCacheMaxDays = 1100;
+
+Priority priorityFor(const Task& task, const QDate& currentDate) {
+    const std::optional<QDate> dueDate = task.date.isValid() ? std::optional<QDate>(task.date) : std::nullopt;
+    return priority::priorityForDeadline(dueDate, task.done, currentDate, Priority::Low);
+}
 }
 
 PlannerService::PlannerService(QObject* parent) 
@@ -133,8 +129,8 @@ void PlannerService::ensureSeed() {
         if (seedHasContent(target, name)) {
             continue;
         }
-        if (QFileInfo::exists(target)) {
-            QFile::remove(target);
+        if (data_file::exists(target)) {
+            data_file::remove(target);
         }
         const QString bundled = locateSeedFile(name);
         QDir().mkpath(m_dataDir);
@@ -161,30 +157,46 @@ bool PlannerService::addOrUpdateExam(const Exam& exam) {
     Exam copy = exam;
     if (copy.id.isEmpty()) copy.id = copy.subjectId + "_" + copy.date.toString(Qt::ISODate);
 
-    bool found = false;
-    for (auto& existing : m_exams) {
-        if (existing.id == copy.id) {
-            existing = copy;
-            found = true;
-            break;
-        }
+    const auto existing = std::find_if(m_exams.begin(), m_exams.end(), [&](const Exam& e) {
+        return e.id == copy.id;
+    });
+    QList<QDate> affected = examWindow(copy);
+    if (existing != m_exams.end()) {
+        affected += examWindow(*existing);
     }
-    if (!found) m_exams.append(copy);
+    const QHash<QDate, QVector<Task>> before = currentPlans(affected);
+
+    if (existing != m_exams.end()) {
+        *existing = copy;
+    } else {
+        m_exams.append(copy);
+    }
+    rebuildExamIndex();
 
     saveExams();
+    replan(before);
     emit dataChanged();
     return true;
 }
 
 bool PlannerService::removeExam(const QString& id) {
-    const int before = m_exams.size();
+    QList<QDate> affected;
+    bool found = false;
+    for (const auto& exam : m_exams) {
+        if (exam.id != id) continue;
+        found = true;
+        affected += examWindow(exam);
+    }
+    if (!found) return false;
+    const QHash<QDate, QVector<Task>> before = currentPlans(affected);
+
     m_exams.erase(std::remove_if(m_exams.begin(), m_exams.end(), [&](const Exam& e) {
         return e.id == id;
     }), m_exams.end());
-
-    if (m_exams.size() == before) return false;
+    rebuildExamIndex();
 
     saveExams();
+    replan(before);
     emit dataChanged();
     return true;
 }
@@ -196,6 +208,7 @@ void PlannerService::setDone(const QDate& date, int index, bool value) {
     } else {
         set.remove(index);
     }
+    m_planCache.byDate.remove(date);
     saveDone();
     emit dataChanged();
 }
@@ -207,40 +220,43 @@ bool PlannerService::isDone(const QDate& date, int index) const {
 }
 
 QVector<Task> PlannerService::generateDay(const QDate& date) const {
+    const QDate today = QDate::currentDate();
+    if (const QVector<Task>* cached = cachedPlan(date, today)) {
+        return *cached;
+    }
+    const QVector<Task> tasks = planDay(snapshot(today), date);
+    storePlan(date, tasks);
+    return tasks;
+}
+
+PlannerService::PlanSnapshot PlannerService::snapshot(const QDate& today) const {
+    return PlanSnapshot{m_subjectIndex, m_plannerConfig, m_examIndex, m_done, today};
+}
+
+QVector<Task> PlannerService::planDay(const PlanSnapshot& state, const QDate& date) {
     QVector<Task> tasks;
     tasks.reserve(8);
 
-    const auto cfg = m_config;
-    const int weekday = date.dayOfWeek() - 1;
-    const auto dailyCapacityObj = cfg.value("daily_capacity_min").toObject();
-    const int capacity = dailyCapacityObj.value(QString::number(weekday)).toInt(0);
-
-    int remaining = capacity;
+    const PlannerConfig& cfg = state.config;
+    int remaining = cfg.capacityFor(date);
     if (remaining <= 0) return tasks;
-
-    for (const auto& breakValue : cfg.value("breaks").toArray()) {
-        const auto window = breakValue.toString();
-        const auto parts = window.split("..");
-        if (parts.size() != 2) continue;
-        const auto start = QDate::fromString(parts.at(0), Qt::ISODate);
-        const auto end = QDate::fromString(parts.at(1), Qt::ISODate);
-        if (!start.isValid() || !end.isValid()) continue;
-        if (date >= start && date <= end) return tasks;
-    }
+    if (cfg.isBreak(date)) return tasks;
 
     QHash<QString, double> weights;
-    for (const auto& subject : m_subjects) {
-        weights.insert(subject.id, baseWeightFor(subject.id));
-    }
-
-    const auto boostDays = cfg.value("exam_boost_days").toArray();
-    const auto boostFactors = cfg.value("exam_boost_factors").toArray();
-    for (const auto& exam : m_exams) {
-        const int diff = date.daysTo(exam.date);
-        for (int i = 0; i < boostDays.size() && i < boostFactors.size(); ++i) {
-            if (diff == boostDays.at(i).toInt()) {
-                weights[exam.subjectId] = weights.value(exam.subjectId, 1.0) * boostFactors.at(i).toDouble(1.15);
-            }
+    weights.reserve(state.subjectIndex.size());
+    for (auto it = state.subjectIndex.cbegin(); it != state.subjectIndex.cend(); ++it) {
+        weights.insert(it.key(), it->weight);
+    }
+
+    // One range query per boost entry for the exams it applies to today.
+    for (const auto& boost : cfg.examBoosts) {
+        const QDate examDate = date.addDays(boost.daysBefore);
+        const auto range = std::equal_range(state.examIndex.cbegin(), state.examIndex.cend(),
+                                            qMakePair(examDate, QString()), [](const auto& a, const auto& b) {
+                                                return a.first < b.first;
+                                            });
+        for (auto it = range.first; it != range.second; ++it) {
+            weights[it->second] = weights.value(it->second, 1.0) * boost.factor;
         }
     }
 
@@ -249,9 +265,11 @@ QVector<Task> PlannerService::generateDay(const QDate& date) const {
         return weights.value(a) > weights.value(b);
     });
 
-    const int maxSlots = cfg.value("max_slots").toInt(3);
-    const int slotMin = cfg.value("slot_min").toInt(20);
-    const int slotMax = cfg.value("slot_max").toInt(40);
+    const int maxSlots = cfg.maxSlots;
+    const int slotMin = cfg.slotMin;
+    const int slotMax = cfg.slotMax;
+    const auto doneIt = state.done.constFind(iso(date));
+    const bool anyDone = doneIt != state.done.cend();
 
     int placed = 0;
     const int seed = date.toJulianDay();
@@ -269,7 +287,7 @@ QVector<Task> PlannerService::generateDay(const QDate& date) const {
             ? std::min(slotMax, std::max(slotMin, ((remaining / remainingSlots + 5) / 10) * 10))
             : slotMin;
 
-        const Subject subject = subjectById(subjectId);
+        const Subject subject = subjectById(state, subjectId);
 
         Task task;
         task.id = makeTaskId(subjectId, date, placed);
@@ -278,11 +296,11 @@ QVector<Task> PlannerService::generateDay(const QDate& date) const {
         task.goal = defaultGoal(subjectId, seed + placed);
         task.durationMinutes = ideal;
         task.date = date;
-        task.done = isDone(date, placed);
+        task.done = anyDone && doneIt.value().contains(placed);
         task.isExam = false;
         task.color = subject.color;
         task.planIndex = placed;
-        task.priority = computePriority(task, QDate::currentDate());
+        task.priority = priorityFor(task, state.today);
 
         tasks.append(task);
         remaining -= ideal;
@@ -293,19 +311,144 @@ QVector<Task> PlannerService::generateDay(const QDate& date) const {
 }
 
 QList<QVector<Task>> PlannerService::generateRange(const QDate& start, const QDate& end) const {
+    const QDate today = QDate::currentDate();
     QList<QVector<Task>> out;
+    QList<int> missingSlots;
+    QList<QDate> missing;
     for (QDate d = start; d <= end; d = d.addDays(1)) {
-        out.append(generateDay(d));
+        if (const QVector<Task>* cached = cachedPlan(d, today)) {
+            out.append(*cached);
+        } else {
+            missingSlots.append(out.size());
+            missing.append(d);
+            out.append({});
+        }
+    }
+    if (missing.isEmpty()) {
+        return out;
+    }
+
+    const PlanSnapshot state = snapshot(today);
+    QList<QVector<Task>> planned;
+    if (missing.size() < kParallelRangeMinDays) {
+        planned.reserve(missing.size());
+        for (const QDate& d : missing) {
+            planned.append(planDay(state, d));
+        }
+    } else {
+        // blockingMapped keeps the input order regardless of which thread finishes first.
+        planned = QtConcurrent::blockingMapped(missing, [&state](const QDate& d) { return planDay(state, d); });
+    }
+    for (int i = 0; i < missing.size(); ++i) {
+        out[missingSlots.at(i)] = planned.at(i);
+        storePlan(missing.at(i), planned.at(i));
     }
     return out;
 }
 
+PlannerService::PlanCacheStats PlannerService::planCacheStats() const {
+    return PlanCacheStats{m_planCache.hits, m_planCache.misses, static_cast<int>(m_planCache.byDate.size())};
+}
+
+const QVector<Task>* PlannerService::cachedPlan(const QDate& date, const QDate& today) const {
+    if (m_planCache.today != today) {
+        // Priorities depend on the current day, so yesterday's plans are stale.
+        m_planCache.byDate.clear();
+        m_planCache.today = today;
+    }
+    const auto it = m_planCache.byDate.constFind(date);
+    if (it == m_planCache.byDate.cend()) {
+        ++m_planCache.misses;
+        return nullptr;
+    }
+    ++m_planCache.hits;
+    return &it.value();
+}
+
+void PlannerService::storePlan(const QDate& date, const QVector<Task>& tasks) const {
+    if (!date.isValid()) {
+        return;
+    }
+    if (m_planCache.byDate.size() >= kPlanCacheMaxDays) {
+        m_planCache.byDate.clear();
+    }
+    m_planCache.byDate.insert(date, tasks);
+}
+
+void PlannerService::clearPlanCache() {
+    m_planCache.byDate.clear();
+}
+
+QList<QDate> PlannerService::examWindow(const Exam& exam) const {
+    QList<QDate> dates;
+    if (!exam.date.isValid()) {
+        return dates; // not in the exam index, boosts nothing
+    }
+    for (const auto& boost : m_plannerConfig.examBoosts) {
+        dates.append(exam.date.addDays(-boost.daysBefore));
+    }
+    return dates;
+}
+
+QHash<QDate, QVector<Task>> PlannerService::currentPlans(const QList<QDate>& dates) const {
+    QHash<QDate, QVector<Task>> plans;
+    for (const QDate& date : dates) {
+        if (!plans.contains(date)) {
+            plans.insert(date, generateDay(date));
+        }
+    }
+    return plans;
+}
+
+void PlannerService::replan(const QHash<QDate, QVector<Task>>& before) {
+    QList<DayPlanDiff> diffs;
+    for (auto it = before.cbegin(); it != before.cend(); ++it) {
+        m_planCache.byDate.remove(it.key());
+        DayPlanDiff diff = diffPlans(it.key(), it.value(), generateDay(it.key()));
+        if (!diff.isEmpty()) {
+            diffs.append(diff);
+        }
+    }
+    if (diffs.isEmpty()) {
+        return;
+    }
+    std::sort(diffs.begin(), diffs.end(), [](const DayPlanDiff& a, const DayPlanDiff& b) { return a.date < b.date; });
+    emit planChanged(diffs);
+}
+
+DayPlanDiff PlannerService::diffPlans(const QDate& date, const QVector<Task>& before, const QVector<Task>& after) {
+    // Plans are compared slot by slot; planIndex is the position within the day.
+    const auto same = [](const Task& a, const Task& b) {
+        return a.id == b.id && a.subjectId == b.subjectId && a.title == b.title && a.goal == b.goal
+            && a.durationMinutes == b.durationMinutes && a.done == b.done && a.color == b.color
+            && a.priority == b.priority;
+    };
+    DayPlanDiff diff;
+    diff.date = date;
+    const int common = std::min(before.size(), after.size());
+    for (int i = 0; i < common; ++i) {
+        if (!same(before.at(i), after.at(i))) {
+            diff.changed.append(after.at(i));
+        }
+    }
+    for (int i = common; i < after.size(); ++i) {
+        diff.added.append(after.at(i));
+    }
+    for (int i = common; i < before.size(); ++i) {
+        diff.removed.append(before.at(i));
+    }
+    return diff;
+}
+
 void PlannerService::loadAll() {
     loadSubjects();
     loadDiagnostics();
     loadConfig();
     loadExams();
     loadDone();
+    rebuildSubjectIndex();
+    rebuildExamIndex();
+    clearPlanCache();
 }
 
 void PlannerService::loadSubjects() {
@@ -333,6 +476,7 @@ void PlannerService::loadDiagnostics() {
 
 void PlannerService::loadConfig() {
     m_config = readJson(QDir(m_dataDir).filePath(QStringLiteral("config.json")));
+    m_plannerConfig = PlannerConfig::fromJson(m_config);
 }
 
 void PlannerService::loadExams() {
@@ -380,7 +524,8 @@ void PlannerService::saveExams() const {
             {"weight_boost", exam.weightBoost}
         });
     }
-    writeJson(QDir(m_dataDir).filePath(QStringLiteral("exams.json")), QJsonObject{{"exams", examsArray}});
+    data_file::writeLater(QDir(m_dataDir).filePath(QStringLiteral("exams.json")),
+                          QJsonDocument(QJsonObject{{"exams", examsArray}}));
 }
 
 void PlannerService::saveDone() const {
@@ -390,25 +535,33 @@ void PlannerService::saveDone() const {
         for (int index : it.value()) indices.append(index);
         doneObj.insert(it.key(), indices);
     }
-    writeJson(QDir(m_dataDir).filePath(QStringLiteral("done.json")), QJsonObject{{"done", doneObj}});
+    data_file::writeLater(QDir(m_dataDir).filePath(QStringLiteral("done.json")),
+                          QJsonDocument(QJsonObject{{"done", doneObj}}));
 }
 
-double PlannerService::baseWeightFor(const QString& subjectId) const {
-    double base = 1.0;
+void PlannerService::rebuildSubjectIndex() {
+    m_subjectIndex.clear();
+    m_subjectIndex.reserve(m_subjects.size());
     for (const auto& subject : m_subjects) {
-        if (subject.id == subjectId) {
-            base = subject.weight;
-            break;
-        }
+        if (m_subjectIndex.contains(subject.id)) continue; // the first entry wins
+        const double weight = subject.weight * m_plannerConfig.levelFactorFor(m_levels.value(subject.id, "B"));
+        m_subjectIndex.insert(subject.id, IndexedSubject{subject, weight});
     }
+}
 
-    const QString level = m_levels.value(subjectId, "B");
-    const auto factors = m_config.value("level_factor").toObject();
-    return base * factors.value(level).toDouble(1.0);
+void PlannerService::rebuildExamIndex() {
+    m_examIndex.clear();
+    m_examIndex.reserve(m_exams.size());
+    for (const auto& exam : m_exams) {
+        if (exam.date.isValid()) {
+            m_examIndex.append(qMakePair(exam.date, exam.subjectId));
+        }
+    }
+    std::sort(m_examIndex.begin(), m_examIndex.end());
 }
 
-QString PlannerService::defaultGoal(const QString& subjectId, int seed) const {
-    const QHash<QString, QStringList> goals = {
+QString PlannerService::defaultGoal(const QString& subjectId, int seed) {
+    static const QHash<QString, QStringList> goals = {
         {"en", {"Reading 250w + 4Q", "Passive drill 12x", "100-word email (clean)", "Listening 10m + notes"}},
         {"de", {"Zusammenfassung 120w", "Erörterungsbausteine", "Kommasetzung-Drill", "Kurzgeschichte deuten"}},
         {"ma", {"Prozent-Drill 10x", "Lineare Funktionen 6x", "Gemischte Aufgaben 15m", "Statistik: Mittel/Median"}},
@@ -431,10 +584,9 @@ QString PlannerService::defaultGoal(const QString& subjectId, int seed) const {
     return list.at(seed % list.size());
 }
 
-Subject PlannerService::subjectById(const QString& subjectId) const {
-    for (const auto& subject : m_subjects) {
-        if (subject.id == subjectId) return subject;
-    }
+Subject PlannerService::subjectById(const PlanSnapshot& state, const QString& subjectId) {
+    const auto it = state.subjectIndex.constFind(subjectId);
+    if (it != state.subjectIndex.cend()) return it->subject;
     Subject fallback;
     fallback.id = subjectId;
     fallback.name = subjectId;
@@ -442,11 +594,10 @@ Subject PlannerService::subjectById(const QString& subjectId) const {
     return fallback;
 }
 
-QString PlannerService::makeTaskId(const QString& subjectId, const QDate& date, int index) const {
+QString PlannerService::makeTaskId(const QString& subjectId, const QDate& date, int index) {
     return iso(date) + ":" + subjectId + ":" + QString::number(index);
 }
 
 Priority PlannerService::computePriority(const Task& task, const QDate& currentDate) const {
-    const std::optional<QDate> dueDate = task.date.isValid() ? std::optional<QDate>(task.date) : std::nullopt;
-    return priority::priorityForDeadline(dueDate, task.done, currentDate, Priority::Low);
+    return priorityFor(task, currentDate);
 }
@@ -3,15 +3,27 @@
 #include "Task.h"
 #include "Subject.h"
 #include "Exam.h"
+#include "PlannerConfig.h"
 #include "SpacedRepetitionService.h"
 
 #include <QHash>
 #include <QJsonObject>
 #include <QList>
 #include <QObject>
+#include <QPair>
 #include <QSet>
 #include <QVector>
 
+// How one day's plan changed. Tasks are matched by planIndex, the slot within the day.
+struct DayPlanDiff {
+    QDate date;
+    QVector<Task> added;   // slots only the new plan has
+    QVector<Task> removed; // slots only the old plan had
+    QVector<Task> changed; // new version of slots whose task differs
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && changed.isEmpty(); }
+};
+
 class PlannerService : public QObject {
     Q_OBJECT
 public:
@@ -33,21 +45,63 @@ public:
     bool isDone(const QDate& date, int index) const;
 
     QVector<Task> generateDay(const QDate& date) const;
+    // Days are planned concurrently on the global thread pool; the result is in date order.
     QList<QVector<Task>> generateRange(const QDate& start, const QDate& end) const;
 
     Priority computePriority(const Task& task, const QDate& currentDate) const;
 
+    struct PlanCacheStats {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        int entries = 0;
+    };
+    PlanCacheStats planCacheStats() const;
+    void clearPlanCache();
+
 Q_SIGNALS:
     void dataChanged();
+    // Emitted before dataChanged() when an exam change altered the plans of days
+    // inside its boost window; only days whose plan actually changed are listed, in
+    // date order.
+    void planChanged(const QList<DayPlanDiff>& diffs);
 
 private:
+    struct IndexedSubject {
+        Subject subject;
+        double weight = 1.0; // subject weight x level factor
+    };
+    using ExamIndex = QVector<QPair<QDate, QString>>; // (date, subject id), sorted
+
+    // Everything a day plan depends on. Copies are cheap (implicit sharing) and
+    // read-only, so worker threads can plan days while the service is modified.
+    struct PlanSnapshot {
+        QHash<QString, IndexedSubject> subjectIndex;
+        PlannerConfig config;
+        ExamIndex examIndex;
+        QHash<QString, QSet<int>> done;
+        QDate today;
+    };
+
+    // Day plans already handed out, keyed by date. Only the owning thread touches
+    // it; generateRange's workers plan from a snapshot and never see the cache.
+    struct PlanCache {
+        QDate today; // plan priorities are relative to this day
+        QHash<QDate, QVector<Task>> byDate;
+        qint64 hits = 0;
+        qint64 misses = 0;
+    };
+
     QString m_dataDir;
     QList<Subject> m_subjects;
     QHash<QString, QString> m_levels;
     QJsonObject m_config;
+    PlannerConfig m_plannerConfig; // m_config compiled by loadConfig()
     QList<Exam> m_exams;
+    QHash<QString, IndexedSubject> m_subjectIndex; // rebuilt by loadAll()
+    ExamIndex m_examIndex;                         // exams with a valid date
     QHash<QString, QSet<int>> m_done; // date ISO -> completed slot indices
     SpacedRepetitionService m_spacedRepetition;
+    mutable PlanCache m_planCache;
 
     void loadAll();
     void loadSubjects();
@@ -58,8 +112,20 @@ private:
     void saveExams() const;
     void saveDone() const;
 
-    double baseWeightFor(const QString& subjectId) const;
-    QString defaultGoal(const QString& subjectId, int variantSeed = 0) const;
-    Subject subjectById(const QString& subjectId) const;
-    QString makeTaskId(const QString& subjectId, const QDate& date, int index) const;
+    PlanSnapshot snapshot(const QDate& today) const;
+    const QVector<Task>* cachedPlan(const QDate& date, const QDate& today) const;
+    void storePlan(const QDate& date, const QVector<Task>& tasks) const;
+    void rebuildSubjectIndex();
+    void rebuildExamIndex();
+    // Days whose plan depends on exam.
+    QList<QDate> examWindow(const Exam& exam) const;
+    QHash<QDate, QVector<Task>> currentPlans(const QList<QDate>& dates) const;
+    // Replans the given days and emits planChanged() for those that differ.
+    void replan(const QHash<QDate, QVector<Task>>& before);
+    static DayPlanDiff diffPlans(const QDate& date, const QVector<Task>& before, const QVector<Task>& after);
+    static QVector<Task> planDay(const PlanSnapshot& state, const QDate& date);
+
+    static QString defaultGoal(const QString& subjectId, int variantSeed = 0);
+    static Subject subjectById(const PlanSnapshot& state, const QString& subjectId);
+    static QString makeTaskId(const QString& subjectId, const QDate& date, int index);
 };
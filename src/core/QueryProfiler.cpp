@@ -0,0 +1,238 @@
+#include "QueryProfiler.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+constexpr std::size_t kMaxSamples = 4096;
+
+// Type and size of each bound value, e.g. "QString(12)", "qlonglong", "NULL".
+QStringList parameterShapes(const QSqlQuery& query) {
+    QStringList shapes;
+    const QVariantList values = query.boundValues();
+    for (const auto& value : values) {
+        if (value.isNull()) {
+            shapes.append(QStringLiteral("NULL"));
+        } else if (value.metaType().id() == QMetaType::QString) {
+            shapes.append(QStringLiteral("QString(%1)").arg(value.toString().size()));
+        } else if (value.metaType().id() == QMetaType::QByteArray) {
+            shapes.append(QStringLiteral("QByteArray(%1)").arg(value.toByteArray().size()));
+        } else {
+            shapes.append(QString::fromLatin1(value.metaType().name()));
+        }
+    }
+    return shapes;
+}
+
+QStringList queryPlan(const QSqlDatabase& db, const QString& sql) {
+    if (!db.isValid() || !db.isOpen() || sql.isEmpty()) {
+        return {};
+    }
+    QSqlQuery explain(db);
+    if (!explain.exec(QStringLiteral("EXPLAIN QUERY PLAN ") + sql)) {
+        return {QStringLiteral("(no plan: %1)").arg(explain.lastError().text())};
+    }
+    QStringList plan;
+    while (explain.next()) {
+        plan.append(explain.value(QStringLiteral("detail")).toString());
+    }
+    return plan;
+}
+
+double percentileMs(std::vector<qint64> sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted[std::min(index, sorted.size() - 1)]) / 1e6;
+}
+} // namespace
+
+QueryProfiler::Timing::Timing(Timing&& other) noexcept
+    : m_profiler(std::exchange(other.m_profiler, nullptr))
+    , m_label(other.m_label)
+    , m_query(other.m_query)
+    , m_sql(std::move(other.m_sql))
+    , m_db(std::move(other.m_db))
+    , m_timer(other.m_timer) {
+}
+
+QueryProfiler::Timing& QueryProfiler::Timing::operator=(Timing&& other) noexcept {
+    if (this != &other) {
+        finish(-1);
+        m_profiler = std::exchange(other.m_profiler, nullptr);
+        m_label = other.m_label;
+        m_query = other.m_query;
+        m_sql = std::move(other.m_sql);
+        m_db = std::move(other.m_db);
+        m_timer = other.m_timer;
+    }
+    return *this;
+}
+
+QueryProfiler::Timing::~Timing() {
+    finish(-1);
+}
+
+void QueryProfiler::Timing::finish(qint64 rows) {
+    if (QueryProfiler* profiler = std::exchange(m_profiler, nullptr)) {
+        profiler->record(*this, rows);
+    }
+}
+
+QueryProfiler::QueryProfiler(const Options& options)
+    : m_options(options) {
+}
+
+QueryProfiler::Timing QueryProfiler::start(const char* label, const QSqlQuery& query, const QSqlDatabase& db) {
+    Timing timing = start(label, QString(), db);
+    timing.m_query = &query;
+    return timing;
+}
+
+QueryProfiler::Timing QueryProfiler::start(const char* label, const QString& sql, const QSqlDatabase& db) {
+    Timing timing;
+    timing.m_profiler = this;
+    timing.m_label = label;
+    timing.m_sql = sql;
+    timing.m_db = db;
+    timing.m_timer.start();
+    return timing;
+}
+
+void QueryProfiler::record(Timing& timing, qint64 rows) {
+    const qint64 nanos = timing.m_timer.nsecsElapsed();
+    const bool slow = nanos >= qint64(m_options.slowThresholdMs) * 1000000;
+    const QString label = QString::fromLatin1(timing.m_label);
+    {
+        QMutexLocker locker(&m_mutex);
+        Samples& samples = m_samples[label];
+        if (samples.nanos.size() < kMaxSamples) {
+            samples.nanos.push_back(nanos);
+        } else {
+            samples.nanos[samples.next] = nanos;
+        }
+        samples.next = (samples.next + 1) % kMaxSamples;
+        ++samples.count;
+        if (slow) {
+            ++samples.slowCount;
+        }
+    }
+    if (!slow) {
+        return;
+    }
+
+    // Still on the statement's thread, so its connection can explain the plan.
+    const QString sql = timing.m_query ? timing.m_query->lastQuery() : timing.m_sql;
+    const double ms = static_cast<double>(nanos) / 1e6;
+    qWarning() << "[QueryProfiler] Slow statement" << label << ms << "ms";
+
+    QString entry;
+    entry += QStringLiteral("%1 %2 %3 ms rows=%4\n")
+                 .arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs), label)
+                 .arg(ms, 0, 'f', 2)
+                 .arg(rows >= 0 ? QString::number(rows) : QStringLiteral("-"));
+    entry += QStringLiteral("  sql: %1\n").arg(sql.simplified());
+    if (timing.m_query) {
+        entry += QStringLiteral("  params: [%1]\n").arg(parameterShapes(*timing.m_query).join(QStringLiteral(", ")));
+    }
+    for (const auto& step : queryPlan(timing.m_db, sql)) {
+        entry += QStringLiteral("  plan: %1\n").arg(step);
+    }
+    appendToLog(entry);
+}
+
+QVector<QueryProfiler::Stats> QueryProfiler::stats() const {
+    QVector<Stats> result;
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_samples.cbegin(); it != m_samples.cend(); ++it) {
+        Stats stats;
+        stats.label = it.key();
+        stats.count = it->count;
+        stats.slowCount = it->slowCount;
+        stats.p50Ms = percentileMs(it->nanos, 0.50);
+        stats.p99Ms = percentileMs(it->nanos, 0.99);
+        stats.maxMs = it->nanos.empty() ? 0.0 : static_cast<double>(*std::max_element(it->nanos.begin(), it->nanos.end())) / 1e6;
+        result.append(stats);
+    }
+    locker.unlock();
+    std::sort(result.begin(), result.end(), [](const Stats& a, const Stats& b) { return a.p99Ms > b.p99Ms; });
+    return result;
+}
+
+QString QueryProfiler::summary() const {
+    QString text = QStringLiteral("%1 %2 %3 %4 %5 %6\n")
+                       .arg(QStringLiteral("statement"), -20)
+                       .arg(QStringLiteral("count"), 8)
+                       .arg(QStringLiteral("slow"), 6)
+                       .arg(QStringLiteral("p50 ms"), 9)
+                       .arg(QStringLiteral("p99 ms"), 9)
+                       .arg(QStringLiteral("max ms"), 9);
+    for (const auto& stats : stats()) {
+        text += QStringLiteral("%1 %2 %3 %4 %5 %6\n")
+                    .arg(stats.label, -20)
+                    .arg(stats.count, 8)
+                    .arg(stats.slowCount, 6)
+                    .arg(stats.p50Ms, 9, 'f', 3)
+                    .arg(stats.p99Ms, 9, 'f', 3)
+                    .arg(stats.maxMs, 9, 'f', 3);
+    }
+    return text;
+}
+
+void QueryProfiler::dumpSummary() const {
+    appendToLog(QStringLiteral("%1 summary (latencies over the newest %2 samples per statement)\n%3")
+                    .arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs))
+                    .arg(kMaxSamples)
+                    .arg(summary()));
+}
+
+void QueryProfiler::appendToLog(const QString& text) const {
+    if (m_options.logPath.isEmpty()) {
+        return;
+    }
+    const QByteArray bytes = text.toUtf8();
+    QMutexLocker locker(&m_logMutex);
+    const QString& path = m_options.logPath;
+    if (QFileInfo(path).size() + bytes.size() > m_options.maxLogBytes && QFile::exists(path)) {
+        // log -> log.1 -> log.2 ...; the oldest file drops out.
+        QFile::remove(QStringLiteral("%1.%2").arg(path).arg(m_options.rotatedLogs));
+        for (int i = m_options.rotatedLogs - 1; i >= 1; --i) {
+            QFile::rename(QStringLiteral("%1.%2").arg(path).arg(i), QStringLiteral("%1.%2").arg(path).arg(i + 1));
+        }
+        if (m_options.rotatedLogs > 0) {
+            QFile::rename(path, path + QStringLiteral(".1"));
+        } else {
+            QFile::remove(path);
+        }
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "[QueryProfiler] Unable to write" << path;
+        return;
+    }
+    file.write(bytes);
+}
+
+std::optional<QueryProfiler::Options> QueryProfiler::fromEnvironment(const QString& defaultLogPath) {
+    bool ok = false;
+    const int threshold = qEnvironmentVariableIntValue("NOAH_PLANNER_SLOW_QUERY_MS", &ok);
+    if (!ok || threshold < 0) {
+        return std::nullopt;
+    }
+    Options options;
+    options.slowThresholdMs = threshold;
+    const QString logPath = qEnvironmentVariable("NOAH_PLANNER_SLOW_QUERY_LOG");
+    options.logPath = logPath.isEmpty() ? defaultLogPath : logPath;
+    return options;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <optional>
+#include <vector>
+
+class QSqlQuery;
+
+// Opt-in timing of repository statements. Every timed statement adds a latency sample
+// under its label; statements slower than the threshold are appended to a rotating
+// log file with their SQL, the types of the bound parameters (never the values), the
+// row count and the EXPLAIN QUERY PLAN output. Safe to use from several threads.
+class QueryProfiler {
+public:
+    struct Options {
+        QString logPath;
+        int slowThresholdMs = 50;
+        qint64 maxLogBytes = 1024 * 1024;
+        int rotatedLogs = 3; // slow-queries.log.1 ... .N
+    };
+
+    struct Stats {
+        QString label;
+        qint64 count = 0;
+        qint64 slowCount = 0;
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    // One statement execution. Recorded by finish(), or on destruction if finish()
+    // was never reached (e.g. an early return after a failed exec). Inactive when
+    // default-constructed, so call sites cost nothing with profiling off.
+    class Timing {
+    public:
+        Timing() = default;
+        Timing(Timing&& other) noexcept;
+        Timing& operator=(Timing&& other) noexcept;
+        Timing(const Timing&) = delete;
+        Timing& operator=(const Timing&) = delete;
+        ~Timing();
+
+        // rows: rows returned or affected; negative if not applicable.
+        void finish(qint64 rows);
+
+    private:
+        friend class QueryProfiler;
+
+        QueryProfiler* m_profiler = nullptr;
+        const char* m_label = nullptr;
+        const QSqlQuery* m_query = nullptr; // SQL and bindings are read only if slow
+        QString m_sql;
+        QSqlDatabase m_db;
+        QElapsedTimer m_timer;
+    };
+
+    explicit QueryProfiler(const Options& options);
+
+    // db must be the connection the statement runs on; it is used on the calling
+    // thread to capture the query plan of slow statements.
+    Timing start(const char* label, const QSqlQuery& query, const QSqlDatabase& db);
+    Timing start(const char* label, const QString& sql, const QSqlDatabase& db);
+
+    Options options() const { return m_options; }
+    QVector<Stats> stats() const;
+    // Table of count, slow count and p50/p99/max latency per label, slowest p99 first.
+    QString summary() const;
+    // Appends summary() to the log file.
+    void dumpSummary() const;
+
+    // NOAH_PLANNER_SLOW_QUERY_MS=<threshold> turns profiling on;
+    // NOAH_PLANNER_SLOW_QUERY_LOG overrides the log path.
+    static std::optional<Options> fromEnvironment(const QString& defaultLogPath);
+
+private:
+    struct Samples {
+        std::vector<qint64> nanos; // ring buffer of the newest samples
+        std::size_t next = 0;
+        qint64 count = 0;
+        qint64 slowCount = 0;
+    };
+
+    Options m_options;
+    mutable QMutex m_mutex;
+    mutable QMutex m_logMutex;
+    QHash<QString, Samples> m_samples;
+
+    void record(Timing& timing, qint64 rows);
+    void appendToLog(const QString& text) const;
+};
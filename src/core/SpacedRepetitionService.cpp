@@ -1,4 +1,5 @@
 #include "SpacedRepetitionService.h"
+#include "DataFile.h"
 
 #include <QDir>
 #include <QFile>
@@ -8,30 +9,18 @@
 #include <QtMath>
 
 namespace {
+// JSON or CBOR, see DataFile.h.
 QJsonObject readJson(const QString& path) {
-    QFile f(path);
-    if (!f.open(QIODevice::ReadOnly)) {
-        qWarning() << "[SpacedRepetitionService] Failed to open file for reading:" << path << f.errorString();
+    const std::optional<QJsonDocument> doc = data_file::read(path);
+    if (!doc) {
+        qWarning() << "[SpacedRepetitionService] Failed to read:" << path;
         return {};
     }
-    const QByteArray data = f.readAll();
-    const auto doc = QJsonDocument::fromJson(data);
-    if (doc.isNull()) {
-        qWarning() << "[SpacedRepetitionService] Failed to parse JSON from:" << path;
-        return {};
-    }
-    return doc.object();
+    return doc->object();
 }
 
 void writeJson(const QString& path, const QJsonObject& obj) {
-    QFile f(path);
-    if (!f.open(QIODevice::WriteOnly)) {
-        qWarning() << "[SpacedRepetitionService] Failed to open file for writing:" << path << f.errorString();
-        return;
-    }
-    const QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Indented);
-    const qint64 written = f.write(data);
-    if (written != data.size()) {
+    if (!data_file::write(path, QJsonDocument(obj))) {
         qWarning() << "[SpacedRepetitionService] Incomplete write to:" << path;
     }
 }
@@ -150,7 +139,7 @@ void SpacedRepetitionService::load() {
 
     const QString path = QDir(m_dataDir).filePath(QStringLiteral("reviews.json"));
 
-    if (!QFileInfo::exists(path)) {
+    if (!data_file::exists(path)) {
         QDir().mkpath(m_dataDir);
         writeJson(path, QJsonObject{{QStringLiteral("reviews"), QJsonArray{}}});
         return;
@@ -201,7 +190,7 @@ void SpacedRepetitionService::save() const {
 
     const QString path = QDir(m_dataDir).filePath(QStringLiteral("reviews.json"));
     QDir().mkpath(m_dataDir);
-    writeJson(path, root);
+    data_file::writeLater(path, QJsonDocument(root));
 }
 
 void SpacedRepetitionService::calculateNextReview(Review& review, int quality) {
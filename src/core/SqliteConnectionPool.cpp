@@ -0,0 +1,246 @@
+#include "SqliteConnectionPool.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QThread>
+#include <QVector>
+
+namespace {
+// WAL readers only wait on the brief checkpoint and recovery locks.
+constexpr const char* kReaderOptions = "QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000";
+
+void applyPragmas(const QSqlDatabase& db, const QStringList& pragmas) {
+    QSqlQuery query(db);
+    for (const auto& pragma : pragmas) {
+        if (!query.exec(pragma)) {
+            qWarning() << "[SqliteConnectionPool] Pragma failed" << pragma << query.lastError();
+        }
+        query.finish();
+    }
+}
+}
+
+SqliteConnectionPool::SqliteConnectionPool(const QString& baseName)
+    : m_baseName(baseName)
+    , m_registry(std::make_shared<Registry>()) {
+}
+
+SqliteConnectionPool::~SqliteConnectionPool() {
+    close();
+}
+
+void SqliteConnectionPool::setConnectionPragmas(const QStringList& pragmas) {
+    QMutexLocker locker(&m_registry->mutex);
+    m_pragmas = pragmas;
+}
+
+bool SqliteConnectionPool::open(const QString& path) {
+    close();
+    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), m_baseName);
+    db.setDatabaseName(path);
+    if (!db.open()) {
+        m_lastError = db.lastError().text();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_baseName);
+        return false;
+    }
+
+    auto writer = std::make_shared<Connection>();
+    writer->name = m_baseName;
+    writer->owner = QThread::currentThread();
+    writer->writer = true;
+    QMutexLocker locker(&m_registry->mutex);
+    applyPragmas(db, m_pragmas);
+    m_path = path;
+    m_lastError.clear();
+    m_writerThread = QThread::currentThread();
+    m_registry->connections.insert(m_writerThread, writer);
+    return true;
+}
+
+void SqliteConnectionPool::close() {
+    QThread* thread = QThread::currentThread();
+    QVector<std::shared_ptr<Connection>> owned;
+    {
+        QMutexLocker locker(&m_registry->mutex);
+        m_writerThread = nullptr;
+        for (const auto& connection : std::as_const(m_registry->connections)) {
+            if (connection->writer || connection->owner == thread) {
+                owned.append(connection);
+            }
+        }
+        // Other readers stay with their threads and are closed there by their finished()
+        // hooks; forgetting them here keeps them out of a reopened pool.
+        m_registry->connections.clear();
+    }
+    for (const auto& connection : std::as_const(owned)) {
+        QObject::disconnect(connection->finishedHook);
+        closeConnection(*connection, m_optimizeOnClose);
+    }
+}
+
+bool SqliteConnectionPool::isOpen() const {
+    QMutexLocker locker(&m_registry->mutex);
+    return m_writerThread != nullptr;
+}
+
+QSqlDatabase SqliteConnectionPool::connection() {
+    const std::shared_ptr<Connection> current = connectionForCurrentThread();
+    if (!current) {
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(current->name, false);
+}
+
+bool SqliteConnectionPool::isWriterThread() const {
+    QMutexLocker locker(&m_registry->mutex);
+    return m_writerThread && m_writerThread == QThread::currentThread();
+}
+
+QSqlQuery* SqliteConnectionPool::prepared(int slot, const QString& sql, bool reuse) {
+    const std::shared_ptr<Connection> current = connectionForCurrentThread();
+    if (!current) {
+        return nullptr;
+    }
+    // Only the owning thread touches a connection's statements, so no lock is needed.
+    std::shared_ptr<QSqlQuery>& cached = current->statements[slot];
+    if (cached && reuse) {
+        return cached.get();
+    }
+    cached = std::make_shared<QSqlQuery>(QSqlDatabase::database(current->name, false));
+    cached->setForwardOnly(true);
+    if (!cached->prepare(sql)) {
+        qWarning() << "[SqliteConnectionPool] prepare failed" << cached->lastError() << sql;
+        cached.reset();
+        return nullptr;
+    }
+    return cached.get();
+}
+
+void SqliteConnectionPool::clearStatements() {
+    // Must not race with queries on other threads; callers use this between workloads.
+    QMutexLocker locker(&m_registry->mutex);
+    for (const auto& connection : std::as_const(m_registry->connections)) {
+        connection->statements.clear();
+    }
+}
+
+void SqliteConnectionPool::finishStatements() {
+    const std::shared_ptr<Connection> current = connectionForCurrentThread();
+    if (!current) {
+        return;
+    }
+    for (const auto& statement : std::as_const(current->statements)) {
+        statement->finish();
+    }
+}
+
+void SqliteConnectionPool::releaseReader() {
+    std::shared_ptr<Connection> released;
+    {
+        QMutexLocker locker(&m_registry->mutex);
+        QThread* thread = QThread::currentThread();
+        if (thread == m_writerThread) {
+            return;
+        }
+        released = m_registry->connections.take(thread);
+    }
+    if (released) {
+        QObject::disconnect(released->finishedHook);
+        closeConnection(*released, false);
+    }
+}
+
+int SqliteConnectionPool::readerCount() const {
+    QMutexLocker locker(&m_registry->mutex);
+    return m_writerThread ? static_cast<int>(m_registry->connections.size()) - 1 : 0;
+}
+
+std::shared_ptr<SqliteConnectionPool::Connection> SqliteConnectionPool::connectionForCurrentThread() {
+    QThread* thread = QThread::currentThread();
+    {
+        QMutexLocker locker(&m_registry->mutex);
+        if (!m_writerThread) {
+            return nullptr;
+        }
+        const auto it = m_registry->connections.constFind(thread);
+        if (it != m_registry->connections.constEnd()) {
+            return it.value();
+        }
+    }
+    return openReader(thread);
+}
+
+std::shared_ptr<SqliteConnectionPool::Connection> SqliteConnectionPool::openReader(QThread* thread) {
+    QString path;
+    QStringList pragmas;
+    auto reader = std::make_shared<Connection>();
+    {
+        QMutexLocker locker(&m_registry->mutex);
+        path = m_path;
+        pragmas = m_pragmas;
+        reader->name = QStringLiteral("%1_reader_%2").arg(m_baseName).arg(++m_nextReaderId);
+        reader->owner = thread;
+    }
+
+    {
+        // Opened on the calling thread, which the connection is then bound to.
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), reader->name);
+        db.setDatabaseName(path);
+        db.setConnectOptions(QString::fromLatin1(kReaderOptions));
+        if (!db.open()) {
+            qWarning() << "[SqliteConnectionPool] Unable to open reader" << db.lastError().text();
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(reader->name);
+            return nullptr;
+        }
+        applyPragmas(db, pragmas);
+    }
+
+    // QThread emits finished() on the finishing thread itself, where the connection
+    // can still be closed cleanly. The hook holds the connection rather than the pool,
+    // so it also works for readers detached by close() or left behind by a destroyed pool.
+    const std::weak_ptr<Registry> registry = m_registry;
+    reader->finishedHook = QObject::connect(thread, &QThread::finished, [registry, thread, reader]() {
+        if (const std::shared_ptr<Registry> live = registry.lock()) {
+            QMutexLocker locker(&live->mutex);
+            if (live->connections.value(thread) == reader) {
+                live->connections.remove(thread);
+            }
+        }
+        // Disconnecting releases this lambda's captures, so keep the connection alive.
+        const std::shared_ptr<Connection> connection = reader;
+        QObject::disconnect(connection->finishedHook);
+        closeConnection(*connection, false);
+    });
+
+    QMutexLocker locker(&m_registry->mutex);
+    if (!m_writerThread) {
+        // The pool was closed while this reader was being opened.
+        locker.unlock();
+        QObject::disconnect(reader->finishedHook);
+        closeConnection(*reader, false);
+        return nullptr;
+    }
+    m_registry->connections.insert(thread, reader);
+    return reader;
+}
+
+void SqliteConnectionPool::closeConnection(Connection& connection, bool optimize) {
+    connection.statements.clear();
+    // A connection may only be closed explicitly from its own thread; removing it from
+    // another thread drops the driver, which closes the handle. Only the writer can get
+    // here from a foreign thread (a repository destroyed off its writer thread).
+    if (connection.owner == QThread::currentThread()) {
+        QSqlDatabase db = QSqlDatabase::database(connection.name, false);
+        if (db.isValid()) {
+            if (connection.writer && optimize) {
+                // Refreshes planner statistics for tables whose queries ran on this connection.
+                applyPragmas(db, {QStringLiteral("PRAGMA optimize")});
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection.name);
+}
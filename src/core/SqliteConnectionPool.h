@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QHash>
+#include <QMetaObject>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+class QThread;
+
+// Thread-affine SQLite connections for one database file. The thread that calls
+// open() owns the writer connection; every other thread that asks for a connection
+// gets its own read-only one, opened on first use. In WAL mode those readers see
+// the last committed state and never block the writer. Each connection keeps its
+// own prepared-statement cache, since QSqlQuery objects are tied to a connection.
+class SqliteConnectionPool {
+public:
+    explicit SqliteConnectionPool(const QString& baseName);
+    ~SqliteConnectionPool();
+
+    SqliteConnectionPool(const SqliteConnectionPool&) = delete;
+    SqliteConnectionPool& operator=(const SqliteConnectionPool&) = delete;
+
+    // Statements run on every connection right after it opens (e.g. PRAGMAs), and
+    // whether the writer runs PRAGMA optimize before closing. Set before open().
+    void setConnectionPragmas(const QStringList& pragmas);
+    void setOptimizeOnClose(bool enabled) { m_optimizeOnClose = enabled; }
+
+    bool open(const QString& path);
+    // Closes the writer and the calling thread's reader. Readers of other threads are
+    // only detached: each is closed on its own thread when that thread finishes, since
+    // a connection and its statements must not be torn down from another thread.
+    void close();
+    bool isOpen() const;
+    QString lastError() const { return m_lastError; }
+
+    // Connection for the calling thread: the writer on the owning thread, otherwise a
+    // read-only connection private to the thread. Invalid if the pool is closed.
+    QSqlDatabase connection();
+    bool isWriterThread() const;
+
+    // Prepared statement on the calling thread's connection, compiled once per slot.
+    // With reuse disabled the statement is re-prepared on every call.
+    QSqlQuery* prepared(int slot, const QString& sql, bool reuse = true);
+    void clearStatements();
+    // Resets the calling thread's cached statements, e.g. before VACUUM, which fails
+    // while any statement on the connection is still active.
+    void finishStatements();
+
+    // Closes the calling thread's reader. Threads managed by QThread release theirs
+    // automatically when they finish, even after the pool itself is gone; call this
+    // from other threads before they exit.
+    void releaseReader();
+    int readerCount() const;
+
+private:
+    struct Connection {
+        QString name;
+        QThread* owner = nullptr;
+        bool writer = false;
+        QHash<int, std::shared_ptr<QSqlQuery>> statements;
+        QMetaObject::Connection finishedHook;
+    };
+
+    struct Registry {
+        QMutex mutex;
+        QHash<QThread*, std::shared_ptr<Connection>> connections;
+    };
+
+    QString m_baseName;
+    QString m_path;
+    QString m_lastError;
+    QStringList m_pragmas;
+    bool m_optimizeOnClose = false;
+    QThread* m_writerThread = nullptr;
+    int m_nextReaderId = 0;
+    // Shared with the finished() hooks of reader threads, which may outlive the pool.
+    // The mutex also guards the members above.
+    std::shared_ptr<Registry> m_registry;
+
+    std::shared_ptr<Connection> connectionForCurrentThread();
+    std::shared_ptr<Connection> openReader(QThread* thread);
+    // Must run on the connection's own thread.
+    static void closeConnection(Connection& connection, bool optimize);
+};
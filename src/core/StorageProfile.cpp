@@ -0,0 +1,76 @@
+#include "StorageProfile.h"
+
+#include <QDebug>
+
+namespace storage_profile {
+
+std::optional<StorageProfile> fromString(const QString& name) {
+    const QString key = name.trimmed().toLower();
+    if (key == QLatin1String("durable")) {
+        return StorageProfile::Durable;
+    }
+    if (key == QLatin1String("balanced")) {
+        return StorageProfile::Balanced;
+    }
+    if (key == QLatin1String("fast")) {
+        return StorageProfile::Fast;
+    }
+    return std::nullopt;
+}
+
+QString toString(StorageProfile profile) {
+    switch (profile) {
+    case StorageProfile::Durable:
+        return QStringLiteral("durable");
+    case StorageProfile::Balanced:
+        return QStringLiteral("balanced");
+    case StorageProfile::Fast:
+        return QStringLiteral("fast");
+    }
+    return QStringLiteral("balanced");
+}
+
+StorageProfile resolve(const QString& configured) {
+    const QString fromEnv = qEnvironmentVariable(kEnvironmentVariable);
+    const QString name = fromEnv.isEmpty() ? configured : fromEnv;
+    if (name.isEmpty()) {
+        return StorageProfile::Balanced;
+    }
+    if (const std::optional<StorageProfile> profile = fromString(name)) {
+        return *profile;
+    }
+    qWarning() << "[StorageProfile] Unknown profile" << name << "- using balanced";
+    return StorageProfile::Balanced;
+}
+
+QStringList connectionPragmas(StorageProfile profile) {
+    // Negative cache_size is in KiB.
+    switch (profile) {
+    case StorageProfile::Durable:
+        return {
+            QStringLiteral("PRAGMA synchronous = FULL"),
+        };
+    case StorageProfile::Balanced:
+        return {
+            QStringLiteral("PRAGMA synchronous = NORMAL"),
+            QStringLiteral("PRAGMA cache_size = -8192"),
+            QStringLiteral("PRAGMA temp_store = MEMORY"),
+            QStringLiteral("PRAGMA mmap_size = 67108864"),
+        };
+    case StorageProfile::Fast:
+        return {
+            QStringLiteral("PRAGMA synchronous = OFF"),
+            QStringLiteral("PRAGMA cache_size = -32768"),
+            QStringLiteral("PRAGMA temp_store = MEMORY"),
+            QStringLiteral("PRAGMA mmap_size = 268435456"),
+            QStringLiteral("PRAGMA wal_autocheckpoint = 4000"),
+        };
+    }
+    return {};
+}
+
+bool optimizeOnClose(StorageProfile profile) {
+    return profile != StorageProfile::Durable;
+}
+
+} // namespace storage_profile
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <optional>
+
+// SQLite tuning for the events database, applied to every connection.
+//   Durable:  synchronous=FULL, SQLite's default cache; every commit is on disk
+//             before it returns, also across power loss.
+//   Balanced: synchronous=NORMAL, which in WAL mode survives application crashes
+//             and may only lose the last commits on power loss. Larger page
+//             cache, memory-mapped reads, in-memory temp tables. The default.
+//   Fast:     synchronous=OFF and bigger caches, for imports and benchmarks; an OS
+//             crash can corrupt the database.
+// Balanced and Fast also run PRAGMA optimize when the writer connection closes.
+enum class StorageProfile {
+    Durable,
+    Balanced,
+    Fast
+};
+
+namespace storage_profile {
+
+constexpr const char* kEnvironmentVariable = "NOAH_PLANNER_STORAGE_PROFILE";
+
+std::optional<StorageProfile> fromString(const QString& name);
+QString toString(StorageProfile profile);
+
+// NOAH_PLANNER_STORAGE_PROFILE wins over the configured name; unknown or empty
+// names fall back to Balanced.
+StorageProfile resolve(const QString& configured);
+
+// PRAGMA statements run on every new connection.
+QStringList connectionPragmas(StorageProfile profile);
+bool optimizeOnClose(StorageProfile profile);
+
+} // namespace storage_profile
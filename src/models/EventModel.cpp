@@ -2,6 +2,8 @@
 
 #include <QVariantMap>
 
+#include <algorithm>
+
 EventModel::EventModel(QObject* parent)
     : QAbstractListModel(parent) {
 }
@@ -91,6 +93,46 @@ void EventModel::replaceAll(const QVector<EventRecord>& events) {
     endResetModel();
 }
 
+void EventModel::applyChanges(const QVector<EventRecord>& changed, const QStringList& removedIds) {
+    for (const auto& id : removedIds) {
+        removeRowAt(indexOfId(id));
+    }
+    for (const auto& record : changed) {
+        const int current = indexOfId(record.id);
+        if (current >= 0) {
+            const bool afterPrevious = current == 0 || !startsBefore(record, m_events.at(current - 1));
+            const bool beforeNext = current + 1 == m_events.size() || !startsBefore(m_events.at(current + 1), record);
+            if (afterPrevious && beforeNext) {
+                m_events[current] = record;
+                emit dataChanged(index(current), index(current));
+                continue;
+            }
+            removeRowAt(current);
+        }
+        const int row = static_cast<int>(
+            std::upper_bound(m_events.cbegin(), m_events.cend(), record, startsBefore) - m_events.cbegin());
+        beginInsertRows(QModelIndex(), row, row);
+        m_events.insert(row, record);
+        endInsertRows();
+    }
+}
+
+bool EventModel::startsBefore(const EventRecord& a, const EventRecord& b) {
+    if (a.start == b.start) {
+        return a.title.toLower() < b.title.toLower();
+    }
+    return a.start < b.start;
+}
+
+void EventModel::removeRowAt(int row) {
+    if (row < 0 || row >= m_events.size()) {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    m_events.removeAt(row);
+    endRemoveRows();
+}
+
 QVariantMap EventModel::eventAt(int index) const {
     QVariantMap map;
     if (index < 0 || index >= m_events.size()) {
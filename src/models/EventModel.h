@@ -56,10 +56,18 @@ public:
     QHash<int, QByteArray> roleNames() const override;
 
     void replaceAll(const QVector<EventRecord>& events);
+    // Applies a delta to a model kept in startsBefore() order: removed ids are dropped,
+    // changed records replace their row (or are inserted) at their sorted position.
+    void applyChanges(const QVector<EventRecord>& changed, const QStringList& removedIds);
     QVector<EventRecord> events() const { return m_events; }
     QVariantMap eventAt(int index) const;
     int indexOfId(const QString& id) const;
 
+    // Display order: start time, then title ignoring case.
+    static bool startsBefore(const EventRecord& a, const EventRecord& b);
+
 private:
     QVector<EventRecord> m_events;
+
+    void removeRowAt(int row);
 };
@@ -38,6 +38,10 @@ void AppState::load() {
         m_viewMode = persistedView;
     }
     m_settings->endGroup();
+
+    m_settings->beginGroup("storage");
+    m_storageProfile = m_settings->value("profile", QStringLiteral("balanced")).toString();
+    m_settings->endGroup();
 }
 
 void AppState::save() const {
@@ -53,6 +57,9 @@ void AppState::save() const {
     m_settings->setValue("setupCompleted", m_setupCompleted);
     m_settings->setValue("viewMode", m_viewMode);
     m_settings->endGroup();
+    m_settings->beginGroup("storage");
+    m_settings->setValue("profile", m_storageProfile);
+    m_settings->endGroup();
     m_settings->sync();
 }
 
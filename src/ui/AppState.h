@@ -49,6 +49,10 @@ public:
     bool setupCompleted() const { return m_setupCompleted; }
     bool setSetupCompleted(bool completed);
 
+    // storage/profile: durable, balanced or fast (see StorageProfile.h). Edited in the
+    // settings file only; NOAH_PLANNER_STORAGE_PROFILE overrides it.
+    QString storageProfile() const { return m_storageProfile; }
+
 private:
     std::unique_ptr<QSettings> m_settings;
     bool m_darkTheme = true;
@@ -61,4 +65,5 @@ private:
     QString m_viewMode = QStringLiteral("month");
     bool m_zenMode = false;
     bool m_setupCompleted = false;
+    QString m_storageProfile = QStringLiteral("balanced");
 };
@@ -8,11 +8,18 @@
 #include <QSet>
 #include <QStandardPaths>
 #include <QTimeZone>
+#include <QUuid>
 
 #include <algorithm>
 
 namespace {
 const QString kDefaultCategoryColor = QStringLiteral("#2F3645");
+constexpr int kSidebarExamLimit = 50;
+constexpr int kEventPageSize = 256;
+// Other processes (e.g. a second instance) are picked up through the change log.
+constexpr int kChangePollIntervalMs = 5000;
+// Larger deltas are cheaper to apply as one model reset.
+constexpr int kIncrementalChangeLimit = 500;
 QString toIsoDate(const QDate& date) {
     return date.toString(Qt::ISODate);
 }
@@ -61,6 +68,15 @@ PlannerBackend::PlannerBackend(QObject* parent)
     rebuildCommands();
     rebuildCategories();
     rebuildSidebar();
+
+    m_changePoll.setInterval(kChangePollIntervalMs);
+    connect(&m_changePoll, &QTimer::timeout, this, [this]() {
+        // Nothing to poll in JSON mode; skip while a refresh is still queued.
+        if (m_eventSequence >= 0 && m_pendingRefreshes == 0) {
+            refreshEvents();
+        }
+    });
+    m_changePoll.start();
     rebuildFocusState();
     rebuildPomodoroState();
     rebuildDueReviews();
@@ -206,7 +222,7 @@ void PlannerBackend::jumpToToday() {
     selectDate(QDate::currentDate());
 }
 
-QVariant PlannerBackend::addQuickEntry(const QString& text) {
+QVariant PlannerBackend::addQuickEntry(const QString& text, const QString& categoryId) {
     const QuickAddResult parsed = m_parser.parse(text);
     if (!parsed.success) {
         notify(tr("Eingabe konnte nicht verarbeitet werden"));
@@ -214,31 +230,41 @@ QVariant PlannerBackend::addQuickEntry(const QString& text) {
     }
 
     EventRecord record = parsed.record;
-    if (!m_repository.insert(record)) {
-        notify(tr("Speichern fehlgeschlagen"));
-        return {};
-    }
-
-    qInfo() << "[QuickAdd]" << record.title
-            << toIsoDateTime(record.start)
-            << toIsoDateTime(record.end)
-            << "allDay=" << record.allDay
-            << "tags=" << record.tags;
-
-    reloadEvents();
-    rebuildSidebar();
-    notify(tr("Eintrag gespeichert"));
+    if (!categoryId.isEmpty()) {
+        record.categoryId = categoryId;
+    }
+    // The id is assigned here so the returned entry matches the one being stored; it
+    // only exists once the storage thread has written it.
+    if (record.id.isEmpty()) {
+        record.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    }
+    m_events.insert(record).then(this, [this, text, id = record.id](const std::optional<EventRecord>& stored) {
+        if (!stored) {
+            notify(tr("Speichern fehlgeschlagen"));
+            emit entryAddFailed(id, text);
+            return;
+        }
+        qInfo() << "[QuickAdd]" << stored->title
+                << toIsoDateTime(stored->start)
+                << toIsoDateTime(stored->end)
+                << "allDay=" << stored->allDay
+                << "tags=" << stored->tags;
+
+        refreshEvents();
+        notify(tr("Eintrag gespeichert"));
+    });
     return toVariant(record);
 }
 
-QVariantList PlannerBackend::search(const QString& query) const {
-    const QVector<EventRecord> hits = m_repository.search(query, m_state.onlyOpen());
-    QVariantList result;
-    result.reserve(hits.size());
-    for (const auto& record : hits) {
-        result.append(toVariant(record));
-    }
-    return result;
+void PlannerBackend::search(const QString& query) {
+    m_events.search(query, m_state.onlyOpen()).then(this, [this, query](const QVector<EventRecord>& hits) {
+        QVariantList result;
+        result.reserve(hits.size());
+        for (const auto& record : hits) {
+            result.append(toVariant(record));
+        }
+        emit searchResultsReady(query, result);
+    });
 }
 
 QVariantList PlannerBackend::dayEvents(const QString& isoDate) const {
@@ -356,12 +382,19 @@ QVariantList PlannerBackend::listBuckets() const {
     return result;
 }
 
-QVariantMap PlannerBackend::eventById(const QString& id) const {
+QVariantMap PlannerBackend::eventById(const QString& id) {
     if (id.isEmpty()) {
         return {};
     }
     for (const auto& record : m_cachedEvents) {
         if (record.id == id) {
+            // The cache holds summary rows; the full record (with notes) follows via
+            // eventLoaded() once the storage thread has read it.
+            m_events.findById(id).then(this, [this](const std::optional<EventRecord>& full) {
+                if (full) {
+                    emit eventLoaded(toVariant(*full));
+                }
+            });
             return toVariant(record);
         }
     }
@@ -372,13 +405,14 @@ void PlannerBackend::setEventDone(const QString& id, bool done) {
     if (id.isEmpty()) {
         return;
     }
-    if (!m_repository.setDone(id, done)) {
-        notify(tr("Status konnte nicht aktualisiert werden"));
-        return;
-    }
-    reloadEvents();
-    rebuildSidebar();
-    notify(done ? tr("Als erledigt markiert") : tr("Als offen markiert"));
+    m_events.setDone(id, done).then(this, [this, done](bool ok) {
+        if (!ok) {
+            notify(tr("Status konnte nicht aktualisiert werden"));
+            return;
+        }
+        refreshEvents();
+        notify(done ? tr("Als erledigt markiert") : tr("Als offen markiert"));
+    });
 }
 
 void PlannerBackend::showToast(const QString& message) {
@@ -399,9 +433,20 @@ void PlannerBackend::initializeStorage() {
     }
     m_storageDir = dir.absolutePath();
 
-    if (!m_repository.initialize(m_storageDir)) {
-        qWarning() << "[PlannerBackend] Repository initialisation failed for" << m_storageDir;
-    }
+    // Opening and migrating the database happens on the storage thread; loads queued
+    // afterwards run once it is ready.
+    const StorageProfile profile = storage_profile::resolve(m_state.storageProfile());
+    m_events.run([dir = m_storageDir, profile](EventRepository& repo) {
+        repo.setProfile(profile);
+        if (!repo.initialize(dir)) {
+            qWarning() << "[PlannerBackend] Repository initialisation failed for" << dir;
+            return;
+        }
+        const QString storePath = repo.isSqlAvailable() ? repo.databasePath() : repo.jsonFallbackPath();
+        qInfo() << "[PlannerBackend] DB path:" << storePath << "profile:" << storage_profile::toString(profile);
+    });
+    // Checkpoint, vacuum and optimize on the storage thread after a minute without writes.
+    m_events.startMaintenance(std::chrono::minutes(5), std::chrono::minutes(1));
 
     if (!m_categoryRepository.initialize(m_storageDir)) {
         qWarning() << "[PlannerBackend] Category repository initialisation failed for" << m_storageDir;
@@ -410,75 +455,164 @@ void PlannerBackend::initializeStorage() {
     m_focusRepository.setStorageDirectory(m_storageDir);
     m_reviewService.setDataDirectory(m_storageDir);
 
-    const QString storePath = m_repository.isSqlAvailable() ? m_repository.databasePath() : m_repository.jsonFallbackPath();
-    qInfo() << "[PlannerBackend] DB path:" << storePath;
     qInfo() << "[PlannerBackend] Categories path:" << m_categoryRepository.categoriesPath();
 }
 
 void PlannerBackend::reloadEvents() {
-    m_cachedEvents = m_repository.loadAll(m_state.onlyOpen());
-    std::sort(m_cachedEvents.begin(), m_cachedEvents.end(), [](const EventRecord& a, const EventRecord& b) {
-        if (a.start == b.start) {
-            return a.title.toLower() < b.title.toLower();
+    struct Snapshot {
+        QVector<EventRecord> records;
+        qint64 sequence = -1;
+    };
+    m_events.read([onlyOpen = m_state.onlyOpen()](EventRepository& repo) {
+        Snapshot snapshot;
+        // Read the sequence first: changes landing in between are replayed by the next
+        // refresh, which is harmless.
+        snapshot.sequence = repo.changeSequence().value_or(-1);
+        snapshot.records = repo.loadAll(onlyOpen, EventProjection::Summary);
+        std::sort(snapshot.records.begin(), snapshot.records.end(), EventModel::startsBefore);
+        return snapshot;
+    }).then(this, [this](const Snapshot& snapshot) {
+        m_cachedEvents = snapshot.records;
+        m_eventSequence = snapshot.sequence;
+        m_eventModel.replaceAll(m_cachedEvents);
+        emit eventsChanged();
+        logEventLoad(m_cachedEvents.size());
+    });
+}
+
+// Applies what changed since the cached state instead of re-reading the table. Falls
+// back to a full reload without a change log (JSON mode), after log pruning, or for
+// large deltas.
+void PlannerBackend::refreshEvents() {
+    if (m_eventSequence < 0) {
+        reloadEvents();
+        rebuildSidebar();
+        return;
+    }
+    struct Delta {
+        std::optional<EventChangeSet> changes;
+        QVector<EventRecord> changed;
+    };
+    ++m_pendingRefreshes;
+    const bool onlyOpen = m_state.onlyOpen();
+    m_events.read([since = m_eventSequence](EventRepository& repo) {
+        Delta delta;
+        delta.changes = repo.changesSince(since);
+        if (delta.changes && delta.changes->complete) {
+            const QStringList ids = delta.changes->inserted + delta.changes->updated;
+            if (!ids.isEmpty() && ids.size() <= kIncrementalChangeLimit) {
+                delta.changed = repo.findByIds(ids, EventProjection::Summary);
+            }
+        }
+        return delta;
+    }).then(this, [this, onlyOpen](const Delta& delta) {
+        --m_pendingRefreshes;
+        if (!delta.changes || !delta.changes->complete
+            || delta.changes->inserted.size() + delta.changes->updated.size() > kIncrementalChangeLimit) {
+            reloadEvents();
+            rebuildSidebar();
+            return;
+        }
+        if (delta.changes->isEmpty()) {
+            m_eventSequence = std::max(m_eventSequence, delta.changes->sequence);
+            return;
         }
-        return a.start < b.start;
+
+        QStringList removed = delta.changes->removed;
+        QVector<EventRecord> changed;
+        QSet<QString> found;
+        for (const auto& record : delta.changed) {
+            found.insert(record.id);
+            if (onlyOpen && record.isDone) {
+                removed.append(record.id);
+            } else {
+                changed.append(record);
+            }
+        }
+        // Rows deleted again between reading the log and fetching them.
+        for (const auto& id : delta.changes->inserted + delta.changes->updated) {
+            if (!found.contains(id)) {
+                removed.append(id);
+            }
+        }
+
+        m_eventModel.applyChanges(changed, removed);
+        m_cachedEvents = m_eventModel.events();
+        m_eventSequence = std::max(m_eventSequence, delta.changes->sequence);
+        emit eventsChanged();
+        rebuildSidebar();
     });
-    m_eventModel.replaceAll(m_cachedEvents);
-    emit eventsChanged();
-    logEventLoad(m_cachedEvents.size());
 }
 
 void PlannerBackend::rebuildSidebar() {
     const QDate today = QDate::currentDate();
     const QDate upcomingEnd = today.addDays(7);
+    const bool onlyOpen = m_state.onlyOpen();
 
-    QVariantList todayItems;
-    QVariantList upcomingItems;
-    QVariantList examItems;
-
-    for (const auto& record : m_cachedEvents) {
-        const QDate eventDate = record.start.date();
-        if (eventDate == today) {
-            todayItems.append(toVariant(record));
-        }
-        if (eventDate > today && eventDate <= upcomingEnd) {
-            upcomingItems.append(toVariant(record));
+    struct SidebarRows {
+        QVector<EventRecord> window;
+        QVector<EventRecord> exams;
+    };
+    // Both lists come from index lookups instead of a pass over every cached event.
+    m_events.read([today, upcomingEnd, onlyOpen](EventRepository& repo) {
+        SidebarRows rows;
+        rows.window = onlyOpen
+            ? repo.openBetween(QDateTime(today, QTime(0, 0)), QDateTime(upcomingEnd.addDays(1), QTime(0, 0)),
+                               EventProjection::Summary)
+            : repo.loadBetween(today, upcomingEnd, false, EventProjection::Summary);
+        rows.exams = repo.upcomingExams(today, kSidebarExamLimit, EventProjection::Summary);
+        return rows;
+    }).then(this, [this, today, upcomingEnd, onlyOpen](const SidebarRows& rows) {
+        QVariantList todayItems;
+        QVariantList upcomingItems;
+        QVariantList examItems;
+
+        for (const auto& record : rows.window) {
+            const QDate eventDate = record.start.date();
+            if (eventDate == today) {
+                todayItems.append(toVariant(record));
+            } else if (eventDate > today && eventDate <= upcomingEnd) {
+                upcomingItems.append(toVariant(record));
+            }
         }
-        if (record.isExam && eventDate >= today) {
+        for (const auto& record : rows.exams) {
+            if (onlyOpen && record.isDone) {
+                continue;
+            }
             examItems.append(toVariant(record));
         }
-    }
 
-    // Sort by priority (high to low) then by start time
-    auto prioritySort = [](const QVariant& a, const QVariant& b) {
-        const QVariantMap aMap = a.toMap();
-        const QVariantMap bMap = b.toMap();
-        const int aPriority = aMap.value(QStringLiteral("priority")).toInt();
-        const int bPriority = bMap.value(QStringLiteral("priority")).toInt();
-        if (aPriority != bPriority) {
-            return aPriority > bPriority; // Higher priority first
-        }
-        return aMap.value(QStringLiteral("start")).toString() < bMap.value(QStringLiteral("start")).toString();
-    };
+        // Sort by priority (high to low) then by start time
+        auto prioritySort = [](const QVariant& a, const QVariant& b) {
+            const QVariantMap aMap = a.toMap();
+            const QVariantMap bMap = b.toMap();
+            const int aPriority = aMap.value(QStringLiteral("priority")).toInt();
+            const int bPriority = bMap.value(QStringLiteral("priority")).toInt();
+            if (aPriority != bPriority) {
+                return aPriority > bPriority; // Higher priority first
+            }
+            return aMap.value(QStringLiteral("start")).toString() < bMap.value(QStringLiteral("start")).toString();
+        };
 
-    std::sort(todayItems.begin(), todayItems.end(), prioritySort);
-    std::sort(upcomingItems.begin(), upcomingItems.end(), prioritySort);
-    std::sort(examItems.begin(), examItems.end(), prioritySort);
+        std::sort(todayItems.begin(), todayItems.end(), prioritySort);
+        std::sort(upcomingItems.begin(), upcomingItems.end(), prioritySort);
+        std::sort(examItems.begin(), examItems.end(), prioritySort);
 
-    if (m_today != todayItems) {
-        m_today = todayItems;
-        emit todayEventsChanged();
-    }
-    if (m_upcoming != upcomingItems) {
-        m_upcoming = upcomingItems;
-        emit upcomingEventsChanged();
-    }
-    if (m_exams != examItems) {
-        m_exams = examItems;
-        emit examEventsChanged();
-    }
+        if (m_today != todayItems) {
+            m_today = todayItems;
+            emit todayEventsChanged();
+        }
+        if (m_upcoming != upcomingItems) {
+            m_upcoming = upcomingItems;
+            emit upcomingEventsChanged();
+        }
+        if (m_exams != examItems) {
+            m_exams = examItems;
+            emit examEventsChanged();
+        }
 
-    rebuildUrgent(today);
+        rebuildUrgent(today);
+    });
 }
 
 void PlannerBackend::rebuildCommands() {
@@ -888,51 +1022,47 @@ bool PlannerBackend::removeCategory(const QString& id) {
     return true;
 }
 
-bool PlannerBackend::setEntryCategory(const QString& entryId, const QString& categoryId) {
+void PlannerBackend::setEntryCategory(const QString& entryId, const QString& categoryId) {
     if (entryId.isEmpty()) {
-        return false;
+        return;
     }
     
-    // Find the event
-    EventRecord record;
-    bool found = false;
-    for (const auto& ev : m_cachedEvents) {
-        if (ev.id == entryId) {
-            record = ev;
-            found = true;
-            break;
+    // Read and write back on the storage thread so the full record (with notes) is
+    // updated. Entries created by addQuickEntry() are not cached yet but their insert
+    // is queued ahead of this job.
+    m_events.run([entryId, categoryId](EventRepository& repo) {
+        std::optional<EventRecord> record = repo.findById(entryId);
+        if (!record) {
+            return std::optional<bool>();
         }
-    }
-    
-    if (!found) {
-        notify(tr("Eintrag nicht gefunden"));
-        return false;
-    }
-    
-    record.categoryId = categoryId;
-    
-    if (!m_repository.update(record)) {
-        notify(tr("Kategorie konnte nicht zugewiesen werden"));
-        return false;
-    }
-    
-    reloadEvents();
-    rebuildSidebar();
-    
-    if (categoryId.isEmpty()) {
-        notify(tr("Kategorie entfernt"));
-    } else {
-        Category cat = m_categoryRepository.findById(categoryId);
-        notify(tr("Kategorie \"%1\" zugewiesen").arg(cat.name));
-    }
-    
-    return true;
+        record->categoryId = categoryId;
+        return std::optional<bool>(repo.update(*record));
+    }).then(this, [this, categoryId](const std::optional<bool>& updated) {
+        if (!updated) {
+            notify(tr("Eintrag nicht gefunden"));
+            return;
+        }
+        if (!*updated) {
+            notify(tr("Kategorie konnte nicht zugewiesen werden"));
+            return;
+        }
+
+        refreshEvents();
+
+        if (categoryId.isEmpty()) {
+            notify(tr("Kategorie entfernt"));
+        } else {
+            Category cat = m_categoryRepository.findById(categoryId);
+            notify(tr("Kategorie \"%1\" zugewiesen").arg(cat.name));
+        }
+    });
 }
 
-bool PlannerBackend::moveEntry(const QString& entryId, const QString& newStartIso, const QString& newEndIso) {
+void PlannerBackend::moveEntry(const QString& entryId, const QString& newStartIso, const QString& newEndIso) {
     if (entryId.isEmpty() || newStartIso.isEmpty() || newEndIso.isEmpty()) {
         notify(tr("Ungültige Parameter für Verschieben"));
-        return false;
+        emit entryMoveFailed(entryId);
+        return;
     }
     
     // Find the event
@@ -948,7 +1078,8 @@ bool PlannerBackend::moveEntry(const QString& entryId, const QString& newStartIs
     
     if (!found) {
         notify(tr("Eintrag nicht gefunden"));
-        return false;
+        emit entryMoveFailed(entryId);
+        return;
     }
     
     // Save old values for undo
@@ -962,34 +1093,40 @@ bool PlannerBackend::moveEntry(const QString& entryId, const QString& newStartIs
     if (!newStart.isValid() || !newEnd.isValid()) {
         qWarning() << "[moveEntry] Invalid dates:" << newStartIso << newEndIso;
         notify(tr("Ungültiges Datum/Uhrzeit"));
-        return false;
+        emit entryMoveFailed(entryId);
+        return;
     }
     
     // Validate that end is after start
     if (newEnd <= newStart) {
         qWarning() << "[moveEntry] End time must be after start time";
         notify(tr("Endzeitpunkt muss nach Startzeitpunkt liegen"));
-        return false;
-    }
-    
-    // Update the record
-    record.start = newStart;
-    record.end = newEnd;
-    
-    // Persist the change
-    if (!m_repository.update(record)) {
-        notify(tr("Verschieben fehlgeschlagen"));
-        return false;
+        emit entryMoveFailed(entryId);
+        return;
     }
     
-    // Reload and notify
-    reloadEvents();
-    rebuildSidebar();
-    
-    // Emit signal for undo support (ToastHost will show the undo snackbar)
-    emit entryMoved(entryId, oldStartIso, oldEndIso);
+    // Persist on the storage thread; the cached row is a summary, so the full record
+    // is re-read there and only start/end are changed.
+    m_events.run([entryId, newStart, newEnd](EventRepository& repo) {
+        std::optional<EventRecord> stored = repo.findById(entryId);
+        if (!stored) {
+            return false;
+        }
+        stored->start = newStart;
+        stored->end = newEnd;
+        return repo.update(*stored);
+    }).then(this, [this, entryId, oldStartIso, oldEndIso](bool ok) {
+        if (!ok) {
+            notify(tr("Verschieben fehlgeschlagen"));
+            emit entryMoveFailed(entryId);
+            return;
+        }
 
-    return true;
+        refreshEvents();
+
+        // Emit signal for undo support (ToastHost will show the undo snackbar)
+        emit entryMoved(entryId, oldStartIso, oldEndIso);
+    });
 }
 
 bool PlannerBackend::focusSessionActive() const {
@@ -1049,10 +1186,25 @@ void PlannerBackend::skipPomodoroPhase() {
     rebuildPomodoroState();
 }
 
-bool PlannerBackend::exportWeekPdf(const QString& filePath, const QString& weekStartIso) {
+QFuture<QVector<EventRecord>> PlannerBackend::eventsInRange(const QDate& first, const QDate& last) {
+    // Pulled page by page on the storage thread so only the requested range is ever
+    // materialised.
+    return m_events.read([first, last, onlyOpen = m_state.onlyOpen()](EventRepository& repo) {
+        QVector<EventRecord> events;
+        repo.forEachPage(EventCursor::at(QDateTime(first, QTime(0, 0))), QDateTime(last.addDays(1), QTime(0, 0)),
+                         kEventPageSize, onlyOpen, EventProjection::Summary, [&](const QVector<EventRecord>& page) {
+            events += page;
+            return true;
+        });
+        return events;
+    });
+}
+
+void PlannerBackend::exportWeekPdf(const QString& filePath, const QString& weekStartIso) {
     if (filePath.trimmed().isEmpty()) {
         notify(tr("Kein Speicherort angegeben"));
-        return false;
+        emit exportFinished(false);
+        return;
     }
 
     QDate start = fromIsoDate(weekStartIso);
@@ -1068,19 +1220,24 @@ bool PlannerBackend::exportWeekPdf(const QString& filePath, const QString& weekS
         start = start.addDays(-1);
     }
 
-    const bool ok = m_exporter.exportWeek(m_cachedEvents, start, filePath);
-    if (ok) {
-        notify(tr("PDF exportiert"));
-    } else {
-        notify(tr("Export fehlgeschlagen"));
-    }
-    return ok;
+    // The export is written once the week's events arrive from the storage thread;
+    // the result is reported through a toast and exportFinished().
+    eventsInRange(start, start.addDays(6)).then(this, [this, start, filePath](const QVector<EventRecord>& events) {
+        const bool ok = m_exporter.exportWeek(events, start, filePath);
+        if (ok) {
+            notify(tr("PDF exportiert"));
+        } else {
+            notify(tr("Export fehlgeschlagen"));
+        }
+        emit exportFinished(ok);
+    });
 }
 
-bool PlannerBackend::exportMonthPdf(const QString& filePath, const QString& monthIso) {
+void PlannerBackend::exportMonthPdf(const QString& filePath, const QString& monthIso) {
     if (filePath.trimmed().isEmpty()) {
         notify(tr("Kein Speicherort angegeben"));
-        return false;
+        emit exportFinished(false);
+        return;
     }
 
     QDate anchor = fromIsoDate(monthIso);
@@ -1091,13 +1248,17 @@ bool PlannerBackend::exportMonthPdf(const QString& filePath, const QString& mont
         anchor = QDate::currentDate();
     }
 
-    const bool ok = m_exporter.exportMonth(m_cachedEvents, anchor.year(), anchor.month(), filePath);
-    if (ok) {
-        notify(tr("Monats-PDF exportiert"));
-    } else {
-        notify(tr("Export fehlgeschlagen"));
-    }
-    return ok;
+    const QDate monthStart(anchor.year(), anchor.month(), 1);
+    const QDate monthEnd = monthStart.addMonths(1).addDays(-1);
+    eventsInRange(monthStart, monthEnd).then(this, [this, anchor, filePath](const QVector<EventRecord>& events) {
+        const bool ok = m_exporter.exportMonth(events, anchor.year(), anchor.month(), filePath);
+        if (ok) {
+            notify(tr("Monats-PDF exportiert"));
+        } else {
+            notify(tr("Export fehlgeschlagen"));
+        }
+        emit exportFinished(ok);
+    });
 }
 
 void PlannerBackend::rebuildCategories() {
@@ -2,7 +2,7 @@
 
 #include "AppState.h"
 #include "core/CategoryRepository.h"
-#include "core/EventRepository.h"
+#include "core/AsyncEventRepository.h"
 #include "core/FocusSessionRepository.h"
 #include "core/PomodoroTimer.h"
 #include "core/QuickAddParser.h"
@@ -14,6 +14,7 @@
 #include <QDate>
 #include <QObject>
 #include <QString>
+#include <QTimer>
 #include <QVariantList>
 #include <QVariantMap>
 #include <QVector>
@@ -104,20 +105,25 @@ public:
     Q_INVOKABLE void setViewMode(const QString& mode);
     Q_INVOKABLE void setOnlyOpenQml(bool value) { setOnlyOpen(value); }
     Q_INVOKABLE void jumpToToday();
-    Q_INVOKABLE QVariant addQuickEntry(const QString& text);
-    Q_INVOKABLE QVariantList search(const QString& query) const;
+    // Returns the parsed entry right away; it is stored on the storage thread, and a
+    // failed insert is reported through entryAddFailed().
+    Q_INVOKABLE QVariant addQuickEntry(const QString& text, const QString& categoryId = QString());
+    // Results arrive through searchResultsReady().
+    Q_INVOKABLE void search(const QString& query);
     Q_INVOKABLE QVariantList dayEvents(const QString& isoDate) const;
     Q_INVOKABLE QVariantList weekEvents(const QString& weekStartIso) const;
     Q_INVOKABLE QVariantList listBuckets() const;
-    Q_INVOKABLE QVariantMap eventById(const QString& id) const;
+    // Returns the cached summary; the full record follows through eventLoaded().
+    Q_INVOKABLE QVariantMap eventById(const QString& id);
     Q_INVOKABLE void setEventDone(const QString& id, bool done);
     Q_INVOKABLE void showToast(const QString& message);
     Q_INVOKABLE QVariantList listCategories() const;
     Q_INVOKABLE bool addCategory(const QString& id, const QString& name, const QString& color);
     Q_INVOKABLE bool updateCategory(const QString& id, const QString& name, const QString& color);
     Q_INVOKABLE bool removeCategory(const QString& id);
-    Q_INVOKABLE bool setEntryCategory(const QString& entryId, const QString& categoryId);
-    Q_INVOKABLE bool moveEntry(const QString& entryId, const QString& newStartIso, const QString& newEndIso);
+    Q_INVOKABLE void setEntryCategory(const QString& entryId, const QString& categoryId);
+    // Completes through entryMoved() or entryMoveFailed().
+    Q_INVOKABLE void moveEntry(const QString& entryId, const QString& newStartIso, const QString& newEndIso);
 
     Q_INVOKABLE void startFocusSession(int minutes = 25);
     Q_INVOKABLE void stopFocusSession(bool completed = true);
@@ -128,8 +134,9 @@ public:
     Q_INVOKABLE void stopPomodoro();
     Q_INVOKABLE void skipPomodoroPhase();
 
-    Q_INVOKABLE bool exportWeekPdf(const QString& filePath, const QString& weekStartIso = QString());
-    Q_INVOKABLE bool exportMonthPdf(const QString& filePath, const QString& monthIso = QString());
+    // Both complete through exportFinished().
+    Q_INVOKABLE void exportWeekPdf(const QString& filePath, const QString& weekStartIso = QString());
+    Q_INVOKABLE void exportMonthPdf(const QString& filePath, const QString& monthIso = QString());
 
     // Spaced Repetition methods
     Q_INVOKABLE QString addReview(const QString& subjectId, const QString& topic);
@@ -153,9 +160,14 @@ signals:
     void examEventsChanged();
     void commandsChanged();
     void searchQueryChanged();
+    void searchResultsReady(const QString& query, const QVariantList& results);
+    void eventLoaded(const QVariantMap& event);
     void categoriesChanged();
     void toastRequested(const QString& message);
     void entryMoved(const QString& entryId, const QString& oldStartIso, const QString& oldEndIso);
+    void entryMoveFailed(const QString& entryId);
+    void entryAddFailed(const QString& entryId, const QString& text);
+    void exportFinished(bool success);
     void urgentEventsChanged();
     void focusSessionActiveChanged();
     void focusSessionChanged();
@@ -169,7 +181,7 @@ signals:
     void showWeekNumbersChanged();
 
 private:
-    EventRepository m_repository;
+    AsyncEventRepository m_events;
     CategoryRepository m_categoryRepository;
     EventModel m_eventModel;
     QuickAddParser m_parser;
@@ -184,6 +196,9 @@ private:
     ViewMode m_viewMode = ViewMode::Month;
     QString m_searchQuery;
     QVector<EventRecord> m_cachedEvents;
+    qint64 m_eventSequence = -1; // change log position of m_cachedEvents; -1 = none
+    int m_pendingRefreshes = 0;
+    QTimer m_changePoll;
     QVariantList m_today;
     QVariantList m_upcoming;
     QVariantList m_exams;
@@ -199,6 +214,7 @@ private:
 
     void initializeStorage();
     void reloadEvents();
+    void refreshEvents();
     void rebuildSidebar();
     void rebuildCommands();
     void rebuildCategories();
@@ -206,6 +222,7 @@ private:
     QVector<EventRecord> filteredEvents() const;
     QVariantList buildDayEvents(const QDate& date) const;
     QVariantList buildRangeEvents(const QDate& start, const QDate& end) const;
+    QFuture<QVector<EventRecord>> eventsInRange(const QDate& first, const QDate& last);
     ViewMode modeFromString(const QString& mode) const;
     QString modeToString(ViewMode mode) const;
     void logEventLoad(int count) const;
@@ -120,10 +120,9 @@ ApplicationWindow {
             return
         }
 
-        var created = planner.addQuickEntry(payload.text)
-        if (created && created.id && payload.categoryId && payload.categoryId.length) {
-            planner.setEntryCategory(created.id, payload.categoryId)
-        }
+        // The category is stored with the entry, so nothing refers to the new id
+        // before the insert has run.
+        planner.addQuickEntry(payload.text, payload.categoryId || "")
     }
 
     function openSettings() {
@@ -369,6 +368,10 @@ ApplicationWindow {
                 globalSearch.text = planner.searchQuery
             }
         }
+        function onEntryAddFailed(entryId, text) {
+            // Saving failed; reopen the quick add with the input so it is not lost.
+            quickAddOpen(text)
+        }
     }
 
     Component.onCompleted: {
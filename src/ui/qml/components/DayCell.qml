@@ -104,10 +104,8 @@ FocusScope {
         var newStartIso = Qt.formatDateTime(newStart, Qt.ISODate)
         var newEndIso = Qt.formatDateTime(newEnd, Qt.ISODate)
         
-        // Call backend to move entry
-        if (planner.moveEntry(dragData.id, newStartIso, newEndIso)) {
-            console.log("Entry moved successfully to", root.isoDate)
-        }
+        // Call backend to move entry; the outcome arrives through entryMoved/entryMoveFailed
+        planner.moveEntry(dragData.id, newStartIso, newEndIso)
     }
 
     Rectangle {
@@ -29,18 +29,26 @@ Item {
                 path = path.substring(7)
             if (!path || !path.length)
                 return
-            var ok = false
+            if (!exporter.planner) {
+                exporter.finished(false)
+                return
+            }
+            // The events load on the storage thread before the PDF is written; the result arrives through exportFinished.
             if (exporterMode === "month") {
-                ok = exporter.planner ? exporter.planner.exportMonthPdf(path) : false
+                exporter.planner.exportMonthPdf(path)
             } else {
-                ok = exporter.planner ? exporter.planner.exportWeekPdf(path) : false
+                exporter.planner.exportWeekPdf(path)
             }
-            exporter.finished(ok)
         }
     }
 
     Connections {
         id: plannerConnection
         target: null
+        ignoreUnknownSignals: true
+
+        function onExportFinished(success) {
+            exporter.finished(success)
+        }
     }
 }
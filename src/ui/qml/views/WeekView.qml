@@ -484,9 +484,7 @@ Item {
         var newStartIso = Qt.formatDateTime(newStart, Qt.ISODate)
         var newEndIso = Qt.formatDateTime(newEnd, Qt.ISODate)
         
-        // Call backend to move entry
-        if (planner.moveEntry(dragData.id, newStartIso, newEndIso)) {
-            console.log("Entry moved to", targetDayIso, "at", snappedMinutes, "minutes")
-        }
+        // Call backend to move entry; the outcome arrives through entryMoved/entryMoveFailed
+        planner.moveEntry(dragData.id, newStartIso, newEndIso)
     }
 }
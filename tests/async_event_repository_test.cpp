@@ -0,0 +1,165 @@
+#include "core/AsyncEventRepository.h"
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFuture>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTime>
+
+#include <iostream>
+#include <string>
+
+namespace {
+struct TestCase {
+    std::string description;
+    bool (*test)();
+};
+
+void reportResult(const std::string& description, bool passed) {
+    std::cout << (passed ? "[PASS] " : "[FAIL] ") << description << '\n';
+}
+
+EventRecord makeEvent(const QString& title, const QDate& date) {
+    EventRecord record;
+    record.title = title;
+    record.start = QDateTime(date, QTime(9, 0));
+    record.end = record.start.addSecs(45 * 60);
+    return record;
+}
+
+// Spins the caller's event loop until the condition holds or the timeout expires.
+template <typename Condition>
+bool waitFor(Condition condition, int timeoutMs = 5000) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 20);
+    }
+    return true;
+}
+
+bool testJobsRunOnStorageThread() {
+    QTemporaryDir dir;
+    AsyncEventRepository storage;
+    if (!dir.isValid() || !storage.initialize(dir.path()).result()) {
+        return false;
+    }
+    QThread* jobThread = nullptr;
+    storage.run([&jobThread](EventRepository&) { jobThread = QThread::currentThread(); }).waitForFinished();
+    return jobThread == storage.thread() && jobThread != QThread::currentThread();
+}
+
+bool testJobsRunInSubmissionOrder() {
+    QTemporaryDir dir;
+    AsyncEventRepository storage;
+    if (!dir.isValid()) {
+        return false;
+    }
+    // Nothing is awaited in between: each request only relies on queue order.
+    storage.initialize(dir.path());
+    EventRecord record = makeEvent(QStringLiteral("Physik"), QDate(2026, 6, 8));
+    record.id = QStringLiteral("physik-1");
+    storage.insert(record);
+    storage.setDone(record.id, true);
+    const std::optional<EventRecord> stored = storage.findById(record.id).result();
+    const QVector<EventRecord> open = storage.loadAll(true).result();
+    return stored && stored->isDone && open.isEmpty();
+}
+
+bool testContinuationsReturnToCallerThread() {
+    QTemporaryDir dir;
+    AsyncEventRepository storage;
+    if (!dir.isValid() || !storage.initialize(dir.path()).result()) {
+        return false;
+    }
+    QObject context;
+    bool delivered = false;
+    QThread* continuationThread = nullptr;
+    std::optional<EventRecord> inserted;
+    storage.insert(makeEvent(QStringLiteral("Latein"), QDate(2026, 6, 9)))
+        .then(&context, [&](const std::optional<EventRecord>& record) {
+            continuationThread = QThread::currentThread();
+            inserted = record;
+            delivered = true;
+        });
+    if (!waitFor([&] { return delivered; })) {
+        return false;
+    }
+    return continuationThread == QThread::currentThread() && inserted && !inserted->id.isEmpty();
+}
+
+bool testMaintenanceRunsWhenIdle() {
+    QTemporaryDir dir;
+    AsyncEventRepository storage;
+    if (!dir.isValid() || !storage.initialize(dir.path()).result()) {
+        return false;
+    }
+    storage.insert(makeEvent(QStringLiteral("Erdkunde"), QDate(2026, 6, 10))).waitForFinished();
+    storage.startMaintenance(std::chrono::milliseconds(20), std::chrono::milliseconds(0));
+    return waitFor([&] {
+        QThread::msleep(30);
+        return !storage.read([](EventRepository& repo) { return repo.maintenanceHistory(1); }).result().isEmpty();
+    });
+}
+
+bool testMaintenanceRunsDuringPolling() {
+    QTemporaryDir dir;
+    AsyncEventRepository storage;
+    if (!dir.isValid() || !storage.initialize(dir.path()).result()) {
+        return false;
+    }
+    storage.insert(makeEvent(QStringLiteral("Musik"), QDate(2026, 6, 11))).waitForFinished();
+    storage.startMaintenance(std::chrono::milliseconds(20), std::chrono::milliseconds(200));
+    // Reads arrive more often than the idle window, like the backend's change poll.
+    QElapsedTimer sincePoll;
+    sincePoll.start();
+    return waitFor([&] {
+        if (sincePoll.elapsed() < 50) {
+            return false;
+        }
+        sincePoll.restart();
+        storage.read([](EventRepository& repo) { return repo.changesSince(0); }).waitForFinished();
+        return !storage.read([](EventRepository& repo) { return repo.maintenanceHistory(1); }).result().isEmpty();
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    std::cout << "=== AsyncEventRepository Test Suite ===\n";
+
+    const std::vector<TestCase> tests = {
+        {"Jobs run on storage thread", testJobsRunOnStorageThread},
+        {"Jobs run in submission order", testJobsRunInSubmissionOrder},
+        {"Continuations return to caller thread", testContinuationsReturnToCallerThread},
+        {"Maintenance runs when idle", testMaintenanceRunsWhenIdle},
+        {"Maintenance runs during read polling", testMaintenanceRunsDuringPolling},
+    };
+
+    bool allPassed = true;
+    for (const auto& test : tests) {
+        try {
+            const bool passed = test.test();
+            reportResult(test.description, passed);
+            allPassed = allPassed && passed;
+        } catch (const std::exception& e) {
+            reportResult(test.description + " (exception: " + e.what() + ")", false);
+            allPassed = false;
+        } catch (...) {
+            reportResult(test.description + " (unknown exception)", false);
+            allPassed = false;
+        }
+    }
+
+    std::cout << '\n' << (allPassed ? "All AsyncEventRepository tests passed." : "Some AsyncEventRepository tests failed.") << '\n';
+    return allPassed ? 0 : 1;
+}
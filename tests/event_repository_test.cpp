@@ -0,0 +1,1163 @@
+#include "core/EventRepository.h"
+#include "core/EventSchema.h"
+#include "core/StorageProfile.h"
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTime>
+#include <QTimeZone>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+struct TestCase {
+    std::string description;
+    bool (*test)();
+};
+
+void reportResult(const std::string& description, bool passed) {
+    std::cout << (passed ? "[PASS] " : "[FAIL] ") << description << '\n';
+}
+
+EventRecord makeEvent(const QString& title, const QDate& date, int hour = 9) {
+    EventRecord record;
+    record.title = title;
+    record.start = QDateTime(date, QTime(hour, 0));
+    record.end = record.start.addSecs(45 * 60);
+    return record;
+}
+
+// Runs a statement on a separate connection and returns the first column of the
+// first row, or -1 on failure.
+int scalarOnFile(const QString& path, const QString& sql) {
+    const QString connection = QStringLiteral("scalar_check");
+    int value = -1;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connection);
+        db.setDatabaseName(path);
+        if (db.open()) {
+            QSqlQuery query(db);
+            if (query.exec(sql)) {
+                value = query.next() ? query.value(0).toInt() : 0;
+            }
+            query.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection);
+    return value;
+}
+
+bool planUsesIndex(const QStringList& plan, const QString& index) {
+    bool usesIndex = false;
+    for (const auto& detail : plan) {
+        if (detail.startsWith(QStringLiteral("SCAN events")) || detail.startsWith(QStringLiteral("SCAN TABLE events"))) {
+            return false;
+        }
+        if (detail.contains(QStringLiteral("USE TEMP B-TREE"))) {
+            return false;
+        }
+        if (detail.contains(index)) {
+            usesIndex = true;
+        }
+    }
+    return usesIndex;
+}
+
+bool testLoadBetweenReturnsInclusiveRange() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path()) || !repo.isSqlAvailable()) {
+        return false;
+    }
+    for (int day = 1; day <= 30; ++day) {
+        EventRecord record = makeEvent(QStringLiteral("Lesson %1").arg(day), QDate(2025, 11, day));
+        if (!repo.insert(record)) {
+            return false;
+        }
+    }
+    const QVector<EventRecord> week = repo.loadBetween(QDate(2025, 11, 10), QDate(2025, 11, 16), false);
+    if (week.size() != 7) {
+        return false;
+    }
+    return week.first().start.date() == QDate(2025, 11, 10) && week.last().start.date() == QDate(2025, 11, 16);
+}
+
+bool testLoadBetweenRespectsOnlyOpen() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord open = makeEvent(QStringLiteral("Open"), QDate(2025, 12, 1));
+    EventRecord done = makeEvent(QStringLiteral("Done"), QDate(2025, 12, 1), 11);
+    repo.insert(open);
+    repo.insert(done);
+    repo.setDone(done.id, true);
+    const QVector<EventRecord> hits = repo.loadBetween(QDate(2025, 12, 1), QDate(2025, 12, 1), true);
+    return hits.size() == 1 && hits.first().id == open.id;
+}
+
+bool testMovedEventFollowsRange() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord record = makeEvent(QStringLiteral("Movable"), QDate(2026, 1, 5));
+    repo.insert(record);
+    record.start = QDateTime(QDate(2026, 1, 9), QTime(10, 0));
+    record.end = record.start.addSecs(3600);
+    repo.update(record);
+    return repo.loadBetween(QDate(2026, 1, 5), QDate(2026, 1, 5), false).isEmpty()
+        && repo.loadBetween(QDate(2026, 1, 9), QDate(2026, 1, 9), false).size() == 1;
+}
+
+bool testRangeQueryUsesStartDayIndex() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    const QString sql = QStringLiteral(
+        "SELECT * FROM events WHERE startDay BETWEEN 2460950 AND 2460980 ORDER BY startDay ASC, start ASC");
+    const QString openSql = QStringLiteral(
+        "SELECT * FROM events WHERE startDay BETWEEN 2460950 AND 2460980 AND isDone = 0 ORDER BY startDay ASC, start ASC");
+    return planUsesIndex(repo.explainQueryPlan(sql), QStringLiteral("idx_events_start_day"))
+        && planUsesIndex(repo.explainQueryPlan(openSql), QStringLiteral("idx_events_start_day"));
+}
+
+bool testLegacyDatabaseIsBackfilled() {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+    {
+        QSqlDatabase legacy = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("legacy_events"));
+        legacy.setDatabaseName(QDir(dir.path()).filePath(QStringLiteral("events.sqlite")));
+        if (!legacy.open()) {
+            return false;
+        }
+        QSqlQuery query(legacy);
+        query.exec(QStringLiteral(
+            "CREATE TABLE events (id TEXT PRIMARY KEY NOT NULL, title TEXT NOT NULL, start DATETIME NOT NULL, end DATETIME,"
+            " allDay INTEGER NOT NULL DEFAULT 0, location TEXT, notes TEXT, tags TEXT, isExam INTEGER NOT NULL DEFAULT 0,"
+            " isDone INTEGER NOT NULL DEFAULT 0, due DATETIME, colorHint TEXT, priority INTEGER NOT NULL DEFAULT 0,"
+            " createdAt DATETIME NOT NULL, updatedAt DATETIME NOT NULL)"));
+        query.exec(QStringLiteral(
+            "INSERT INTO events (id, title, start, createdAt, updatedAt) VALUES"
+            " ('legacy-1', 'Legacy', '2025-10-27T08:00:00', '2025-10-01T00:00:00Z', '2025-10-01T00:00:00Z')"));
+        legacy.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("legacy_events"));
+
+    EventRepository repo;
+    if (!repo.initialize(dir.path())) {
+        return false;
+    }
+    const QVector<EventRecord> hits = repo.loadBetween(QDate(2025, 10, 27), QDate(2025, 10, 27), false);
+    if (hits.size() != 1 || hits.first().id != QStringLiteral("legacy-1")) {
+        return false;
+    }
+    if (hits.first().start != QDateTime(QDate(2025, 10, 27), QTime(8, 0))) {
+        return false;
+    }
+
+    bool migrated = false;
+    {
+        QSqlDatabase check = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("legacy_check"));
+        check.setDatabaseName(QDir(dir.path()).filePath(QStringLiteral("events.sqlite")));
+        if (check.open()) {
+            QSqlQuery version(check);
+            QSqlQuery types(check);
+            migrated = version.exec(QStringLiteral("PRAGMA user_version")) && version.next() && version.value(0).toInt() >= 1
+                && types.exec(QStringLiteral("SELECT typeof(start), typeof(createdAt) FROM events")) && types.next()
+                && types.value(0).toString() == QStringLiteral("integer")
+                && types.value(1).toString() == QStringLiteral("integer");
+            check.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("legacy_check"));
+    return migrated;
+}
+
+bool testMalformedLegacyTimestampIsQuarantined() {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("events.sqlite"));
+    {
+        QSqlDatabase legacy = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("legacy_malformed"));
+        legacy.setDatabaseName(path);
+        if (!legacy.open()) {
+            return false;
+        }
+        QSqlQuery query(legacy);
+        query.exec(QStringLiteral(
+            "CREATE TABLE events (id TEXT PRIMARY KEY NOT NULL, title TEXT NOT NULL, start DATETIME NOT NULL, end DATETIME,"
+            " allDay INTEGER NOT NULL DEFAULT 0, location TEXT, notes TEXT, tags TEXT, isExam INTEGER NOT NULL DEFAULT 0,"
+            " isDone INTEGER NOT NULL DEFAULT 0, due DATETIME, colorHint TEXT, priority INTEGER NOT NULL DEFAULT 0,"
+            " createdAt DATETIME NOT NULL, updatedAt DATETIME NOT NULL)"));
+        query.exec(QStringLiteral(
+            "INSERT INTO events (id, title, start, end, createdAt, updatedAt) VALUES"
+            " ('legacy-ok', 'Physik', '2025-10-28T09:00:00', 'gestern', 'kaputt', '2025-10-01T00:00:00Z'),"
+            " ('legacy-bad', 'Chemie', '28.10.2025 9 Uhr', NULL, '2025-10-01T00:00:00Z', '2025-10-01T00:00:00Z')"));
+        legacy.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("legacy_malformed"));
+
+    // The migration has to finish so the repository stays on SQLite.
+    EventRepository repo;
+    if (!repo.initialize(dir.path()) || !repo.isSqlAvailable()) {
+        return false;
+    }
+    const QVector<EventRecord> all = repo.loadAll(false);
+    return all.size() == 1 && all.first().id == QStringLiteral("legacy-ok") && !all.first().end.isValid()
+        && scalarOnFile(path, QStringLiteral("PRAGMA user_version")) == event_schema::latestVersion()
+        && scalarOnFile(path, QStringLiteral("SELECT count(*) FROM events_quarantine WHERE id = 'legacy-bad'"
+                                             " AND start = '28.10.2025 9 Uhr' AND reason <> ''")) == 1;
+}
+
+bool testTimestampsRoundTripWithZones() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    const QDate day(2026, 3, 29); // DST switch in Europe
+    const QVector<QDateTime> starts = {
+        QDateTime(day, QTime(8, 0)),
+        QDateTime(day, QTime(8, 0), QTimeZone::utc()),
+        QDateTime(day, QTime(8, 0), QTimeZone(2 * 3600)),
+        QDateTime(day, QTime(8, 0), QTimeZone("Europe/Berlin")),
+    };
+    for (const auto& start : starts) {
+        EventRecord record = makeEvent(QStringLiteral("Zone"), day);
+        record.start = start;
+        record.end = start.addSecs(90 * 60);
+        record.due = start.addDays(1);
+        if (!repo.insert(record)) {
+            return false;
+        }
+        const std::optional<EventRecord> loaded = repo.findById(record.id);
+        if (!loaded || loaded->start != start || loaded->end != record.end || loaded->due != record.due) {
+            return false;
+        }
+        if (loaded->start.timeSpec() != start.timeSpec() || loaded->start.date() != day) {
+            return false;
+        }
+    }
+    return repo.loadBetween(day, day, false).size() == starts.size();
+}
+
+bool testSearchFoldsGermanSpelling() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord record = makeEvent(QStringLiteral("Mathe Klausur"), QDate(2026, 2, 3));
+    record.location = QStringLiteral("Raum Ü12");
+    record.notes = QStringLiteral("Übungsblatt zur Größe von Flächen");
+    repo.insert(record);
+
+    const QStringList terms = {QStringLiteral("uebung"), QStringLiteral("Übung"), QStringLiteral("groesse"),
+                               QStringLiteral("größe"), QStringLiteral("klau"), QStringLiteral("mathe raum")};
+    for (const auto& term : terms) {
+        const QVector<EventRecord> hits = repo.search(term, false);
+        if (hits.size() != 1 || hits.first().id != record.id) {
+            return false;
+        }
+    }
+    return repo.search(QStringLiteral("deutsch"), false).isEmpty();
+}
+
+bool testSearchIgnoresSyntaxOnlyTerms() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    repo.insert(makeEvent(QStringLiteral("Mathe Klausur"), QDate(2026, 2, 3)));
+    repo.insert(makeEvent(QStringLiteral("Physik Test"), QDate(2026, 2, 4)));
+    // These fold to an empty FTS expression and must not turn into "match everything".
+    for (const auto& term : {QStringLiteral("*"), QStringLiteral("\""), QStringLiteral("* \"")}) {
+        if (!repo.search(term, false).isEmpty()) {
+            return false;
+        }
+    }
+    return repo.search(QStringLiteral("mathe"), false).size() == 1;
+}
+
+bool testSearchRanksTitleMatchesFirst() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord notesOnly = makeEvent(QStringLiteral("Deutsch"), QDate(2026, 2, 1));
+    notesOnly.notes = QStringLiteral("Vokabeln für Englisch wiederholen, danach Physik lesen");
+    EventRecord titleHit = makeEvent(QStringLiteral("Physik Test"), QDate(2026, 2, 20));
+    repo.insert(notesOnly);
+    repo.insert(titleHit);
+    const QVector<EventRecord> hits = repo.search(QStringLiteral("physik"), false);
+    return hits.size() == 2 && hits.first().id == titleHit.id;
+}
+
+bool testSearchIndexFollowsMutations() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord record = makeEvent(QStringLiteral("Chemie"), QDate(2026, 3, 2));
+    repo.insert(record);
+    record.title = QStringLiteral("Biologie");
+    repo.update(record);
+    if (!repo.search(QStringLiteral("chemie"), false).isEmpty() || repo.search(QStringLiteral("bio"), false).size() != 1) {
+        return false;
+    }
+    repo.setDone(record.id, true);
+    if (!repo.search(QStringLiteral("bio"), true).isEmpty()) {
+        return false;
+    }
+    repo.remove(record.id);
+    return repo.search(QStringLiteral("bio"), false).isEmpty();
+}
+
+bool testApplyBatchReportsPerItemResults() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord keep = makeEvent(QStringLiteral("Keep"), QDate(2026, 4, 1));
+    EventRecord drop = makeEvent(QStringLiteral("Drop"), QDate(2026, 4, 2));
+    repo.insert(keep);
+    repo.insert(drop);
+
+    keep.title = QStringLiteral("Keep (updated)");
+    EventRecord missing = makeEvent(QStringLiteral("Missing"), QDate(2026, 4, 3));
+    missing.id = QStringLiteral("does-not-exist");
+    QVector<EventRecord> inserts = {makeEvent(QStringLiteral("New A"), QDate(2026, 4, 4)),
+                                    makeEvent(QStringLiteral("New B"), QDate(2026, 4, 5))};
+    const EventBatchResult result = repo.applyBatch(inserts, {keep, missing}, {drop.id, QStringLiteral("unknown")});
+
+    if (!result.committed || result.changedCount() != 4) {
+        return false;
+    }
+    if (result.updated != QVector<bool>{true, false} || result.removed != QVector<bool>{true, false}
+        || result.inserted != QVector<bool>{true, true}) {
+        return false;
+    }
+    if (inserts.at(0).id.isEmpty() || inserts.at(1).id.isEmpty()) {
+        return false;
+    }
+    const QVector<EventRecord> all = repo.loadAll(false);
+    return all.size() == 3 && all.first().title == QStringLiteral("Keep (updated)");
+}
+
+bool testApplyBatchRollsBackFailedItems() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord existing = makeEvent(QStringLiteral("Englisch"), QDate(2026, 4, 6));
+    repo.insert(existing);
+    // Tag rows for "kaputt" are rejected, so those items fail after their events row
+    // has already been written.
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("events.sqlite"));
+    if (scalarOnFile(path, QStringLiteral("CREATE TRIGGER reject_tag BEFORE INSERT ON event_tags WHEN new.tag = 'kaputt'"
+                                          " BEGIN SELECT RAISE(ABORT, 'rejected'); END")) != 0) {
+        return false;
+    }
+
+    EventRecord good = makeEvent(QStringLiteral("Gut"), QDate(2026, 4, 7));
+    good.tags = {QStringLiteral("ok")};
+    EventRecord bad = makeEvent(QStringLiteral("Schlecht"), QDate(2026, 4, 8));
+    bad.tags = {QStringLiteral("kaputt")};
+    EventRecord badUpdate = existing;
+    badUpdate.title = QStringLiteral("Englisch (geändert)");
+    badUpdate.tags = {QStringLiteral("kaputt")};
+    QVector<EventRecord> inserts = {good, bad};
+    const EventBatchResult result = repo.applyBatch(inserts, {badUpdate}, {});
+
+    if (!result.committed || result.inserted != QVector<bool>{true, false} || result.updated != QVector<bool>{false}) {
+        return false;
+    }
+    const std::optional<EventRecord> unchanged = repo.findById(existing.id);
+    return repo.loadAll(false).size() == 2 && !repo.findById(inserts.at(1).id) && unchanged
+        && unchanged->title == QStringLiteral("Englisch") && repo.findByTag(QStringLiteral("ok"), false).size() == 1;
+}
+
+bool testSummaryProjectionSkipsNotes() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord record = makeEvent(QStringLiteral("Projekt"), QDate(2026, 5, 4));
+    record.location = QStringLiteral("Aula");
+    record.notes = QStringLiteral("Lange Notizen zum Projekt");
+    record.tags = QStringList{QStringLiteral("schule"), QStringLiteral("projekt")};
+    repo.insert(record);
+
+    const QVector<EventRecord> summary = repo.loadAll(false, EventProjection::Summary);
+    const QVector<EventRecord> ranged = repo.loadBetween(QDate(2026, 5, 1), QDate(2026, 5, 31), false, EventProjection::Summary);
+    const QVector<EventRecord> full = repo.loadAll(false);
+    if (summary.size() != 1 || ranged.size() != 1 || full.size() != 1) {
+        return false;
+    }
+    if (!summary.first().notes.isEmpty() || !ranged.first().notes.isEmpty()) {
+        return false;
+    }
+    if (summary.first().location != record.location || summary.first().tags != record.tags
+        || summary.first().start != record.start) {
+        return false;
+    }
+    const std::optional<EventRecord> byId = repo.findById(record.id);
+    return full.first().notes == record.notes && byId && byId->notes == record.notes && byId->tags == record.tags;
+}
+
+bool testTagQueriesUseTagTable() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord exam = makeEvent(QStringLiteral("Mathe Klausur"), QDate(2026, 2, 9));
+    exam.tags = QStringList{QStringLiteral("Mathe"), QStringLiteral("Prüfung")};
+    EventRecord homework = makeEvent(QStringLiteral("Mathe Hausaufgabe"), QDate(2026, 2, 10));
+    homework.tags = QStringList{QStringLiteral("mathe")};
+    EventRecord essay = makeEvent(QStringLiteral("Aufsatz"), QDate(2026, 2, 11));
+    essay.tags = QStringList{QStringLiteral("deutsch")};
+    if (!repo.insert(exam) || !repo.insert(homework) || !repo.insert(essay)) {
+        return false;
+    }
+
+    const QStringList mathExam{QStringLiteral("mathe"), QStringLiteral("pruefung")};
+    if (repo.findByTag(QStringLiteral("MATHE"), false).size() != 2
+        || repo.findByTags(mathExam, TagMatch::All, false).size() != 1
+        || repo.findByTags({QStringLiteral("prüfung"), QStringLiteral("deutsch")}, TagMatch::Any, false).size() != 2) {
+        return false;
+    }
+    const QVector<EventRecord> tagged = repo.search(QStringLiteral("#mathe hausaufgabe"), false);
+    if (tagged.size() != 1 || tagged.first().id != homework.id) {
+        return false;
+    }
+
+    homework.tags = QStringList{QStringLiteral("erledigt")};
+    repo.update(homework);
+    repo.remove(exam.id);
+    if (!repo.findByTag(QStringLiteral("mathe"), false).isEmpty()
+        || repo.findByTag(QStringLiteral("erledigt"), false).size() != 1) {
+        return false;
+    }
+
+    const QString sql = QStringLiteral(
+        "SELECT id FROM events WHERE id IN (SELECT event_id FROM event_tags WHERE tag IN (?, ?)"
+        " GROUP BY event_id HAVING COUNT(*) = 2) ORDER BY start ASC");
+    const QStringList plan = repo.explainQueryPlan(sql);
+    bool usesTagIndex = false;
+    for (const auto& detail : plan) {
+        if (detail.startsWith(QStringLiteral("SCAN events")) || detail.startsWith(QStringLiteral("SCAN TABLE events"))) {
+            return false;
+        }
+        usesTagIndex = usesTagIndex || detail.contains(QStringLiteral("idx_event_tags_tag"));
+    }
+    return usesTagIndex;
+}
+
+bool testSidebarQueriesUseIndexes() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord open = makeEvent(QStringLiteral("Offen"), QDate(2026, 4, 13), 8);
+    EventRecord done = makeEvent(QStringLiteral("Erledigt"), QDate(2026, 4, 13), 10);
+    done.isDone = true;
+    EventRecord later = makeEvent(QStringLiteral("Danach"), QDate(2026, 4, 14), 8);
+    EventRecord pastExam = makeEvent(QStringLiteral("Alte Klausur"), QDate(2026, 4, 1));
+    pastExam.isExam = true;
+    EventRecord examA = makeEvent(QStringLiteral("Klausur A"), QDate(2026, 4, 20));
+    examA.isExam = true;
+    EventRecord examB = makeEvent(QStringLiteral("Klausur B"), QDate(2026, 4, 16));
+    examB.isExam = true;
+    for (EventRecord* record : {&open, &done, &later, &pastExam, &examA, &examB}) {
+        if (!repo.insert(*record)) {
+            return false;
+        }
+    }
+
+    const QVector<EventRecord> window = repo.openBetween(QDateTime(QDate(2026, 4, 13), QTime(0, 0)),
+                                                         QDateTime(QDate(2026, 4, 14), QTime(8, 0)));
+    if (window.size() != 1 || window.first().id != open.id) {
+        return false;
+    }
+    const QVector<EventRecord> exams = repo.upcomingExams(QDate(2026, 4, 13), 1, EventProjection::Summary);
+    if (exams.size() != 1 || exams.first().id != examB.id) {
+        return false;
+    }
+
+    const QString openSql = QStringLiteral(
+        "SELECT id FROM events WHERE isDone = 0 AND start >= ? AND start < ? ORDER BY start ASC");
+    const QString examSql = QStringLiteral(
+        "SELECT id FROM events WHERE isExam = 1 AND start >= ? ORDER BY start ASC LIMIT ?");
+    const QString externalSql = QStringLiteral(
+        "SELECT id FROM events WHERE source = ? AND externalId = ? LIMIT 1");
+    return planUsesIndex(repo.explainQueryPlan(openSql), QStringLiteral("idx_events_open_start"))
+        && planUsesIndex(repo.explainQueryPlan(examSql), QStringLiteral("idx_events_exam_start"))
+        && planUsesIndex(repo.explainQueryPlan(externalSql), QStringLiteral("idx_events_source_external_id"));
+}
+
+bool testExternalIdsAreUniquePerSource() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord first = makeEvent(QStringLiteral("Import"), QDate(2026, 1, 12));
+    first.source = QStringLiteral("untis");
+    first.externalId = QStringLiteral("uid-1");
+    EventRecord duplicate = first;
+    duplicate.id.clear();
+    EventRecord otherSource = first;
+    otherSource.id.clear();
+    otherSource.source = QStringLiteral("ics");
+    EventRecord manualA = makeEvent(QStringLiteral("Manuell A"), QDate(2026, 1, 12));
+    manualA.externalId = QStringLiteral("");
+    EventRecord manualB = makeEvent(QStringLiteral("Manuell B"), QDate(2026, 1, 12));
+    manualB.externalId = QStringLiteral("");
+    return repo.insert(first) && !repo.insert(duplicate) && repo.insert(otherSource)
+        && repo.insert(manualA) && repo.insert(manualB) && repo.loadAll(false).size() == 4;
+}
+
+bool testExternalIdMigrationQuarantinesDuplicates() {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("events.sqlite"));
+    {
+        EventRepository repo;
+        if (!repo.initialize(dir.path())) {
+            return false;
+        }
+    }
+    // Rewind to before migration 4 with rows the old importer could leave behind.
+    const QString insert = QStringLiteral(
+        "INSERT INTO events (id, title, start, source, externalId, createdAt, updatedAt) VALUES ('%1', '%1', %2, %3, %4, 0, 0)");
+    const QStringList setup = {
+        QStringLiteral("DROP INDEX idx_events_source_external_id"),
+        insert.arg(QStringLiteral("untis-old")).arg(1000).arg(QStringLiteral("'untis'"), QStringLiteral("'uid-1'")),
+        insert.arg(QStringLiteral("untis-new")).arg(2000).arg(QStringLiteral("'untis'"), QStringLiteral("'uid-1'")),
+        insert.arg(QStringLiteral("manual-a")).arg(3000).arg(QStringLiteral("NULL"), QStringLiteral("'x-1'")),
+        insert.arg(QStringLiteral("manual-b")).arg(4000).arg(QStringLiteral("NULL"), QStringLiteral("'x-1'")),
+        QStringLiteral("PRAGMA user_version = 3"),
+    };
+    for (const QString& sql : setup) {
+        if (scalarOnFile(path, sql) < 0) {
+            return false;
+        }
+    }
+
+    EventRepository repo;
+    if (!repo.initialize(dir.path()) || !repo.isSqlAvailable()) {
+        return false;
+    }
+    QSet<QString> ids;
+    for (const auto& record : repo.loadAll(false)) {
+        ids.insert(record.id);
+    }
+    return ids == QSet<QString>{QStringLiteral("untis-new"), QStringLiteral("manual-a"), QStringLiteral("manual-b")}
+        && scalarOnFile(path, QStringLiteral("SELECT count(*) FROM events_quarantine WHERE id = 'untis-old'")) == 1
+        && scalarOnFile(path, QStringLiteral("SELECT count(*) FROM events_quarantine")) == 1
+        && scalarOnFile(path, QStringLiteral("SELECT count(*) FROM sqlite_master"
+                                             " WHERE name = 'idx_events_source_external_id'")) == 1;
+}
+
+bool testKeysetPagesCoverRangeOnce() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    // Several events share a start time so pages have to break ties on id.
+    for (int i = 0; i < 25; ++i) {
+        EventRecord record = makeEvent(QStringLiteral("Stunde %1").arg(i), QDate(2026, 9, 1).addDays(i / 5), 8);
+        if (!repo.insert(record)) {
+            return false;
+        }
+    }
+
+    QVector<EventRecord> streamed;
+    int pages = 0;
+    const bool ok = repo.forEachPage(EventCursor(), QDateTime(), 7, false, EventProjection::Summary,
+                                     [&](const QVector<EventRecord>& page) {
+        ++pages;
+        streamed += page;
+        return true;
+    });
+    if (!ok || pages != 4 || streamed.size() != 25) {
+        return false;
+    }
+    QSet<QString> ids;
+    for (int i = 0; i < streamed.size(); ++i) {
+        ids.insert(streamed.at(i).id);
+        if (i > 0) {
+            const EventRecord& prev = streamed.at(i - 1);
+            const EventRecord& cur = streamed.at(i);
+            if (cur.start < prev.start || (cur.start == prev.start && cur.id <= prev.id)) {
+                return false;
+            }
+        }
+    }
+    if (ids.size() != 25) {
+        return false;
+    }
+
+    // Bounded range, and early stop after the first page.
+    const std::optional<EventPage> window = repo.fetchPage(EventCursor::at(QDateTime(QDate(2026, 9, 2), QTime(0, 0))),
+                                                           QDateTime(QDate(2026, 9, 3), QTime(0, 0)), 100, false);
+    int stoppedAfter = 0;
+    repo.forEachPage(EventCursor(), QDateTime(), 10, false, EventProjection::Summary, [&](const QVector<EventRecord>& page) {
+        stoppedAfter += page.size();
+        return false;
+    });
+    if (!window || window->records.size() != 5 || window->hasMore || stoppedAfter != 10) {
+        return false;
+    }
+
+    const QString pageSql = QStringLiteral(
+        "SELECT id FROM events WHERE (start, id) > (?, ?) AND start < ? ORDER BY start ASC, id ASC LIMIT ?");
+    const QString openPageSql = QStringLiteral(
+        "SELECT id FROM events WHERE (start, id) > (?, ?) AND start < ? AND isDone = 0 ORDER BY start ASC, id ASC LIMIT ?");
+    return planUsesIndex(repo.explainQueryPlan(pageSql), QStringLiteral("idx_events_start_id"))
+        && planUsesIndex(repo.explainQueryPlan(openPageSql), QStringLiteral("idx_events_open_start"));
+}
+
+bool testWarmStartLeavesSchemaUntouched() {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("events.sqlite"));
+    {
+        EventRepository repo;
+        if (!repo.initialize(dir.path())) {
+            return false;
+        }
+    }
+    // schema_version is bumped by SQLite on every DDL statement.
+    const int cookie = scalarOnFile(path, QStringLiteral("PRAGMA schema_version"));
+    {
+        EventRepository repo;
+        if (!repo.initialize(dir.path())) {
+            return false;
+        }
+    }
+    return cookie > 0 && scalarOnFile(path, QStringLiteral("PRAGMA schema_version")) == cookie
+        && scalarOnFile(path, QStringLiteral("PRAGMA user_version")) == event_schema::latestVersion();
+}
+
+bool testMigrationsAreIdempotent() {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("events.sqlite"));
+    {
+        EventRepository repo;
+        EventRecord record = makeEvent(QStringLiteral("Chemie Klausur"), QDate(2026, 3, 2));
+        if (!repo.initialize(dir.path()) || !repo.insert(record)) {
+            return false;
+        }
+    }
+    // Replaying every step over an up-to-date schema must not fail or duplicate data.
+    if (scalarOnFile(path, QStringLiteral("PRAGMA user_version = 0")) < 0) {
+        return false;
+    }
+    EventRepository repo;
+    if (!repo.initialize(dir.path()) || !repo.isSqlAvailable()) {
+        return false;
+    }
+    return scalarOnFile(path, QStringLiteral("PRAGMA user_version")) == event_schema::latestVersion()
+        && repo.loadAll(false).size() == 1 && repo.search(QStringLiteral("chemie"), false).size() == 1;
+}
+
+bool testConcurrentReadsDuringBulkWrite() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    const QDate first(2026, 9, 1);
+    const int seeded = 200;
+    const int written = 2000;
+    QVector<EventRecord> seed;
+    for (int i = 0; i < seeded; ++i) {
+        seed.append(makeEvent(QStringLiteral("Mathe Übung %1").arg(i), first.addDays(i % 30)));
+    }
+    if (!repo.applyBatch(seed, {}, {}).committed) {
+        return false;
+    }
+
+    // Readers must see either the state before the batch or after it, never a part.
+    std::atomic<bool> stop{false};
+    std::atomic<bool> consistent{true};
+    std::atomic<int> sawCompleted{0};
+    std::atomic<int> started{0};
+    const auto allowed = [&](int count) { return count == seeded || count == seeded + written; };
+    std::vector<std::unique_ptr<QThread>> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back(QThread::create([&, r]() {
+            bool firstRound = true;
+            while (!stop.load()) {
+                const int inRange = static_cast<int>(repo.loadBetween(first, first.addDays(29), false,
+                                                                      EventProjection::Summary).size());
+                const int found = static_cast<int>(repo.search(QStringLiteral("mathe"), false).size());
+                if (!allowed(inRange) || !allowed(found)) {
+                    consistent = false;
+                }
+                if (r == 0 && inRange == seeded + written) {
+                    ++sawCompleted;
+                }
+                if (firstRound) {
+                    firstRound = false;
+                    ++started;
+                }
+            }
+        }));
+        readers.back()->start();
+    }
+    // Let every reader open its connection before the write starts.
+    while (started.load() < 3 && consistent.load()) {
+        QThread::msleep(1);
+    }
+    const int readerConnections = repo.readerConnectionCount();
+
+    QVector<EventRecord> inserts;
+    for (int i = 0; i < written; ++i) {
+        inserts.append(makeEvent(QStringLiteral("Mathe Klausur %1").arg(i), first.addDays(i % 30), 8 + i % 10));
+    }
+    const bool committed = repo.applyBatch(inserts, {}, {}).committed;
+    while (committed && sawCompleted.load() == 0 && consistent.load()) {
+        QThread::msleep(1);
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader->wait();
+    }
+
+    // Writes from any thread but the one that initialized the repository are rejected.
+    bool rejected = false;
+    std::unique_ptr<QThread> writer(QThread::create([&]() {
+        EventRecord stray = makeEvent(QStringLiteral("Fremd"), first);
+        rejected = !repo.insert(stray);
+    }));
+    writer->start();
+    writer->wait();
+
+    return committed && consistent.load() && readerConnections == 3 && rejected
+        && repo.readerConnectionCount() == 0
+        && repo.loadBetween(first, first.addDays(29), false).size() == seeded + written;
+}
+
+bool testReaderOutlivesRepository() {
+    QTemporaryDir dir;
+    auto repo = std::make_unique<EventRepository>();
+    if (!dir.isValid() || !repo->initialize(dir.path())) {
+        return false;
+    }
+    const auto readerConnections = []() {
+        const QStringList names = QSqlDatabase::connectionNames();
+        return std::count_if(names.begin(), names.end(),
+                             [](const QString& name) { return name.contains(QStringLiteral("_reader_")); });
+    };
+    const auto before = readerConnections();
+
+    // The reader stays alive past the repository; its connection must be closed on
+    // its own thread when it finishes, not by the repository's destructor.
+    std::atomic<bool> opened{false};
+    std::atomic<bool> release{false};
+    std::unique_ptr<QThread> reader(QThread::create([&]() {
+        repo->loadAll(false);
+        opened = true;
+        while (!release.load()) {
+            QThread::msleep(1);
+        }
+    }));
+    reader->start();
+    while (!opened.load()) {
+        QThread::msleep(1);
+    }
+    repo.reset();
+    const auto whileRunning = readerConnections();
+    release = true;
+    reader->wait();
+    return whileRunning == before + 1 && readerConnections() == before;
+}
+
+bool testChangesSinceReportsDeltas() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord kept = makeEvent(QStringLiteral("Deutsch"), QDate(2026, 10, 5));
+    EventRecord dropped = makeEvent(QStringLiteral("Kunst"), QDate(2026, 10, 6));
+    if (!repo.insert(kept) || !repo.insert(dropped)) {
+        return false;
+    }
+    const std::optional<qint64> base = repo.changeSequence();
+    if (!base || *base <= 0) {
+        return false;
+    }
+
+    EventRecord added = makeEvent(QStringLiteral("Musik"), QDate(2026, 10, 7));
+    EventRecord transient = makeEvent(QStringLiteral("Sport"), QDate(2026, 10, 8));
+    kept.title = QStringLiteral("Deutsch Aufsatz");
+    if (!repo.update(kept) || !repo.setDone(kept.id, true) || !repo.remove(dropped.id) || !repo.insert(added)
+        || !repo.insert(transient) || !repo.remove(transient.id)) {
+        return false;
+    }
+    // A second connection on the same file stands in for another process.
+    EventRecord external = makeEvent(QStringLiteral("Religion"), QDate(2026, 10, 9));
+    {
+        EventRepository other;
+        if (!other.initialize(dir.path()) || !other.insert(external)) {
+            return false;
+        }
+    }
+
+    const std::optional<EventChangeSet> changes = repo.changesSince(*base);
+    const std::optional<EventChangeSet> none = changes ? repo.changesSince(changes->sequence) : std::nullopt;
+    if (!changes || !none || !changes->complete || !none->complete || !none->isEmpty()) {
+        return false;
+    }
+    if (changes->inserted != QStringList{added.id, external.id} || changes->updated != QStringList{kept.id}
+        || changes->removed != QStringList{dropped.id} || changes->sequence != repo.changeSequence()) {
+        return false;
+    }
+
+    // Once the entries after base are pruned, a reader at base has to reload.
+    return repo.pruneChanges(changes->sequence) && !repo.changesSince(*base)->complete
+        && repo.changesSince(changes->sequence)->complete;
+}
+
+bool testStorageProfileResolution() {
+    const QByteArray saved = qgetenv(storage_profile::kEnvironmentVariable);
+    qunsetenv(storage_profile::kEnvironmentVariable);
+    const bool fromConfig = storage_profile::resolve(QStringLiteral(" Durable ")) == StorageProfile::Durable
+        && storage_profile::resolve(QString()) == StorageProfile::Balanced
+        && storage_profile::resolve(QStringLiteral("turbo")) == StorageProfile::Balanced;
+    qputenv(storage_profile::kEnvironmentVariable, "fast");
+    const bool envWins = storage_profile::resolve(QStringLiteral("durable")) == StorageProfile::Fast;
+
+    // Every profile must leave a working repository behind.
+    bool allOpen = true;
+    for (const StorageProfile profile : {StorageProfile::Durable, StorageProfile::Balanced, StorageProfile::Fast}) {
+        QTemporaryDir dir;
+        EventRepository repo;
+        repo.setProfile(profile);
+        EventRecord record = makeEvent(QStringLiteral("Geschichte"), QDate(2026, 11, 3));
+        allOpen = allOpen && dir.isValid() && repo.initialize(dir.path()) && repo.insert(record)
+            && repo.findById(record.id).has_value();
+    }
+
+    if (saved.isNull()) {
+        qunsetenv(storage_profile::kEnvironmentVariable);
+    } else {
+        qputenv(storage_profile::kEnvironmentVariable, saved);
+    }
+    return fromConfig && envWins && allOpen;
+}
+
+bool testMaintenanceReclaimsSpace() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    QVector<EventRecord> inserts;
+    for (int i = 0; i < 1500; ++i) {
+        EventRecord record = makeEvent(QStringLiteral("Vokabeln %1").arg(i), QDate(2026, 1, 5).addDays(i % 90));
+        record.notes = QStringLiteral("Lernkarten Kapitel %1. ").repeated(40).arg(i);
+        inserts.append(record);
+    }
+    if (!repo.applyBatch(inserts, {}, {}).committed) {
+        return false;
+    }
+    QStringList removals;
+    for (const auto& record : inserts) {
+        removals.append(record.id);
+    }
+    QVector<EventRecord> noInserts;
+    if (!repo.applyBatch(noInserts, {}, removals).committed) {
+        return false;
+    }
+
+    MaintenancePolicy policy;
+    policy.checkpointWalBytes = 1;
+    const std::optional<MaintenanceReport> report = repo.runMaintenance(policy);
+    const QVector<MaintenanceReport> history = repo.maintenanceHistory(5);
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("events.sqlite"));
+    return report && report->actions.contains(QStringLiteral("incremental vacuum"))
+        && report->actions.contains(QStringLiteral("checkpoint")) && report->freePagesAfter < report->freePagesBefore
+        && report->walBytesAfter == 0 && history.size() == 1 && history.first().actions == report->actions
+        && scalarOnFile(path, QStringLiteral("PRAGMA auto_vacuum")) == 2;
+}
+
+bool testSearchSurvivesFullVacuum() {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+    // A file written before the repository opens it keeps auto_vacuum = NONE, so
+    // maintenance has to run a full VACUUM.
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("events.sqlite"));
+    if (scalarOnFile(path, QStringLiteral("CREATE TABLE placeholder (x INTEGER)")) != 0) {
+        return false;
+    }
+    EventRepository repo;
+    if (!repo.initialize(dir.path()) || scalarOnFile(path, QStringLiteral("PRAGMA auto_vacuum")) != 0) {
+        return false;
+    }
+    QVector<EventRecord> inserts;
+    for (int i = 0; i < 1500; ++i) {
+        EventRecord record = makeEvent(QStringLiteral("Vokabeln %1").arg(i), QDate(2026, 1, 5).addDays(i % 90));
+        record.notes = QStringLiteral("Lernkarten Kapitel %1. ").repeated(40).arg(i);
+        inserts.append(record);
+    }
+    EventRecord kept = makeEvent(QStringLiteral("Physik Referat"), QDate(2026, 4, 1));
+    inserts.append(kept);
+    if (!repo.applyBatch(inserts, {}, {}).committed) {
+        return false;
+    }
+    kept = inserts.last();
+    QStringList removals;
+    for (int i = 0; i < 1500; ++i) {
+        removals.append(inserts.at(i).id);
+    }
+    QVector<EventRecord> noInserts;
+    if (!repo.applyBatch(noInserts, {}, removals).committed) {
+        return false;
+    }
+
+    MaintenancePolicy policy;
+    policy.vacuumMinFreePages = 1;
+    const std::optional<MaintenanceReport> report = repo.runMaintenance(policy);
+    const bool hasFts = scalarOnFile(path, QStringLiteral("SELECT count(*) FROM sqlite_master WHERE name = 'events_fts'")) == 1;
+    if (!report || !report->actions.contains(QStringLiteral("vacuum (enabled incremental auto-vacuum)"))
+        || (hasFts && !report->actions.contains(QStringLiteral("rebuilt search index")))) {
+        return false;
+    }
+
+    const QVector<EventRecord> hits = repo.search(QStringLiteral("physik"), false);
+    if (hits.size() != 1 || hits.first().id != kept.id || !repo.search(QStringLiteral("vokabeln"), false).isEmpty()) {
+        return false;
+    }
+    // The triggers must still address the right index rows after the rewrite.
+    kept.title = QStringLiteral("Chemie Referat");
+    if (!repo.update(kept)) {
+        return false;
+    }
+    const QVector<EventRecord> renamed = repo.search(QStringLiteral("chemie"), false);
+    return renamed.size() == 1 && renamed.first().id == kept.id && repo.search(QStringLiteral("physik"), false).isEmpty()
+        && (!hasFts || scalarOnFile(path, QStringLiteral("SELECT count(*) FROM events_fts")) == 1);
+}
+
+bool testSlowQueryLogCapturesPlan() {
+    QTemporaryDir dir;
+    EventRepository repo;
+    if (!dir.isValid() || !repo.initialize(dir.path())) {
+        return false;
+    }
+    QueryProfiler::Options options;
+    options.logPath = QDir(dir.path()).filePath(QStringLiteral("slow-queries.log"));
+    options.slowThresholdMs = 0; // every statement counts as slow
+    repo.setQueryProfiling(options);
+
+    EventRecord record = makeEvent(QStringLiteral("Physik Referat"), QDate(2026, 3, 2));
+    if (!repo.insert(record)) {
+        return false;
+    }
+    repo.loadBetween(QDate(2026, 3, 1), QDate(2026, 3, 7), false);
+
+    QFile log(options.logPath);
+    if (!log.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    const QString text = QString::fromUtf8(log.readAll());
+    const QVector<QueryProfiler::Stats> stats = repo.queryStats();
+    const bool counted = std::any_of(stats.begin(), stats.end(), [](const QueryProfiler::Stats& s) {
+        return s.label == QStringLiteral("loadBetween") && s.count == 1 && s.slowCount == 1;
+    });
+    // Parameter types are logged, never the values.
+    return counted && text.contains(QStringLiteral("loadBetween")) && text.contains(QStringLiteral("plan: "))
+        && text.contains(QStringLiteral("idx_events_start_day")) && text.contains(QStringLiteral("params: ["))
+        && !text.contains(QStringLiteral("Physik Referat"));
+}
+
+bool testJsonJournalReplaysAndCompacts() {
+    QTemporaryDir dir;
+    // A directory in place of the database file makes SQLite fail to open.
+    if (!dir.isValid() || !QDir(dir.path()).mkdir(QStringLiteral("events.sqlite"))) {
+        return false;
+    }
+    const QString snapshotPath = QDir(dir.path()).filePath(QStringLiteral("events.json"));
+    QStringList ids;
+    {
+        EventRepository repo;
+        if (!repo.initialize(dir.path()) || repo.isSqlAvailable()) {
+            return false;
+        }
+        for (int i = 0; i < 3; ++i) {
+            EventRecord record = makeEvent(QStringLiteral("Chemie %1").arg(i), QDate(2026, 4, 6 + i));
+            if (!repo.insert(record)) {
+                return false;
+            }
+            ids.append(record.id);
+        }
+        EventRecord renamed = *repo.findById(ids.at(1));
+        renamed.title = QStringLiteral("Chemie Klausur");
+        QVector<EventRecord> batchInserts{makeEvent(QStringLiteral("Chemie 3"), QDate(2026, 4, 10))};
+        if (!repo.setDone(ids.at(0), true) || !repo.update(renamed) || !repo.remove(ids.at(2))
+            || repo.remove(ids.at(2)) || !repo.applyBatch(batchInserts, {}, {ids.at(0)}).committed) {
+            return false;
+        }
+        ids.append(batchInserts.first().id);
+
+        // Mutations only append; the snapshot is untouched until compaction.
+        QFile snapshot(snapshotPath);
+        if (!snapshot.open(QIODevice::ReadOnly) || snapshot.readAll() != "[]") {
+            return false;
+        }
+        QFile journal(repo.jsonJournalPath());
+        if (!journal.open(QIODevice::Append)) {
+            return false;
+        }
+        journal.write("{\"op\":\"put\",\"rec");
+        journal.close();
+    }
+
+    EventRepository reopened;
+    if (!reopened.initialize(dir.path())) {
+        return false;
+    }
+    EventRecord late = makeEvent(QStringLiteral("Chemie 4"), QDate(2026, 4, 11));
+    if (!reopened.insert(late)) {
+        return false;
+    }
+    const auto expected = [&](const QVector<EventRecord>& all) {
+        return all.size() == 3 && all.at(0).id == ids.at(1) && all.at(0).title == QStringLiteral("Chemie Klausur")
+            && all.at(1).id == ids.at(3) && all.at(2).id == late.id;
+    };
+    if (!expected(reopened.loadAll(false)) || !reopened.compactJsonJournal()
+        || QFile::exists(reopened.jsonJournalPath())) {
+        return false;
+    }
+    return expected(reopened.loadAll(false));
+}
+
+bool testJsonCacheFollowsOtherWriters() {
+    QTemporaryDir dir;
+    if (!dir.isValid() || !QDir(dir.path()).mkdir(QStringLiteral("events.sqlite"))) {
+        return false;
+    }
+    EventRepository first;
+    EventRepository second;
+    if (!first.initialize(dir.path()) || !second.initialize(dir.path()) || first.isSqlAvailable()) {
+        return false;
+    }
+    EventRecord lesson = makeEvent(QStringLiteral("Geschichte"), QDate(2026, 5, 4));
+    lesson.source = QStringLiteral("untis");
+    lesson.externalId = QStringLiteral("lesson-1");
+    if (!first.insert(lesson) || second.loadBetween(QDate(2026, 5, 4), QDate(2026, 5, 4), false).size() != 1) {
+        return false;
+    }
+    // Each instance answers from its own cache and reloads when the other one writes.
+    if (!second.setDone(lesson.id, true) || !first.findById(lesson.id)->isDone
+        || first.loadBetween(QDate(2026, 5, 4), QDate(2026, 5, 4), true).size() != 0) {
+        return false;
+    }
+    if (!second.removeBySource(QStringLiteral("untis"))) {
+        return false;
+    }
+    return !first.findByExternalId(QStringLiteral("untis"), QStringLiteral("lesson-1")) && first.loadAll(false).isEmpty();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+
+    std::cout << "=== EventRepository Test Suite ===\n";
+
+    const std::vector<TestCase> tests = {
+        {"Load between returns inclusive range", testLoadBetweenReturnsInclusiveRange},
+        {"Load between respects only open", testLoadBetweenRespectsOnlyOpen},
+        {"Moved event follows range", testMovedEventFollowsRange},
+        {"Range query uses start day index", testRangeQueryUsesStartDayIndex},
+        {"Legacy database is backfilled", testLegacyDatabaseIsBackfilled},
+        {"Malformed legacy timestamp is quarantined", testMalformedLegacyTimestampIsQuarantined},
+        {"Timestamps round trip with zones", testTimestampsRoundTripWithZones},
+        {"Search folds German spelling", testSearchFoldsGermanSpelling},
+        {"Search ignores syntax-only terms", testSearchIgnoresSyntaxOnlyTerms},
+        {"Search ranks title matches first", testSearchRanksTitleMatchesFirst},
+        {"Search index follows mutations", testSearchIndexFollowsMutations},
+        {"Apply batch reports per-item results", testApplyBatchReportsPerItemResults},
+        {"Apply batch rolls back failed items", testApplyBatchRollsBackFailedItems},
+        {"Summary projection skips notes", testSummaryProjectionSkipsNotes},
+        {"Tag queries use tag table", testTagQueriesUseTagTable},
+        {"Sidebar queries use indexes", testSidebarQueriesUseIndexes},
+        {"External ids are unique per source", testExternalIdsAreUniquePerSource},
+        {"External id migration quarantines duplicates", testExternalIdMigrationQuarantinesDuplicates},
+        {"Keyset pages cover range once", testKeysetPagesCoverRangeOnce},
+        {"Warm start leaves schema untouched", testWarmStartLeavesSchemaUntouched},
+        {"Migrations are idempotent", testMigrationsAreIdempotent},
+        {"Concurrent reads during bulk write", testConcurrentReadsDuringBulkWrite},
+        {"Reader outlives repository", testReaderOutlivesRepository},
+        {"Changes since reports deltas", testChangesSinceReportsDeltas},
+        {"Storage profile resolution", testStorageProfileResolution},
+        {"Maintenance reclaims space", testMaintenanceReclaimsSpace},
+        {"Search survives full VACUUM", testSearchSurvivesFullVacuum},
+        {"Slow-query log captures plan", testSlowQueryLogCapturesPlan},
+        {"JSON journal replays and compacts", testJsonJournalReplaysAndCompacts},
+        {"JSON cache follows other writers", testJsonCacheFollowsOtherWriters},
+    };
+
+    bool allPassed = true;
+    for (const auto& test : tests) {
+        try {
+            const bool passed = test.test();
+            reportResult(test.description, passed);
+            allPassed = allPassed && passed;
+        } catch (const std::exception& e) {
+            reportResult(test.description + " (exception: " + e.what() + ")", false);
+            allPassed = false;
+        } catch (...) {
+            reportResult(test.description + " (unknown exception)", false);
+            allPassed = false;
+        }
+    }
+
+    std::cout << '\n' << (allPassed ? "All EventRepository tests passed." : "Some EventRepository tests failed.") << '\n';
+    return allPassed ? 0 : 1;
+}
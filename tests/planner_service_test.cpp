@@ -1,3 +1,4 @@
+#include "core/PlannerConfig.h"
 #include "core/PlannerService.h"
 #include "core/Task.h"
 #include "core/Subject.h"
@@ -10,6 +11,7 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QSet>
 #include <QTemporaryDir>
 
 #include <iostream>
@@ -25,6 +27,19 @@ void reportResult(const std::string& description, bool passed) {
     std::cout << (passed ? "[PASS] " : "[FAIL] ") << description << '\n';
 }
 
+bool samePlan(const QVector<Task>& a, const QVector<Task>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (int i = 0; i < a.size(); ++i) {
+        if (a.at(i).id != b.at(i).id || a.at(i).goal != b.at(i).goal
+            || a.at(i).durationMinutes != b.at(i).durationMinutes || a.at(i).done != b.at(i).done) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool testGenerateDayReturnsTasksForValidDate(PlannerService& planner) {
     const QDate today = QDate::currentDate();
     const QVector<Task> tasks = planner.generateDay(today);
@@ -111,6 +126,174 @@ bool testGenerateRangeReturnsCorrectNumberOfDays(PlannerService& planner) {
     return range.size() == 7; // 7 days inclusive
 }
 
+bool testParallelRangeMatchesGenerateDay(PlannerService& planner) {
+    // Long enough to take the thread-pool path.
+    const QDate start(2025, 10, 25);
+    const QDate end = start.addDays(120);
+    planner.setDone(start.addDays(90), 0, true);
+    planner.clearPlanCache();
+    const QList<QVector<Task>> range = planner.generateRange(start, end);
+    planner.clearPlanCache(); // compare against freshly planned days, not cache hits
+
+    bool matches = range.size() == start.daysTo(end) + 1;
+    for (int day = 0; day < range.size() && matches; ++day) {
+        matches = samePlan(planner.generateDay(start.addDays(day)), range.at(day));
+    }
+    planner.setDone(start.addDays(90), 0, false);
+    return matches;
+}
+
+bool testPlanCacheInvalidatesTouchedDates(PlannerService& planner) {
+    const QJsonArray boostDays = planner.config().value("exam_boost_days").toArray();
+    if (boostDays.isEmpty()) {
+        return true; // nothing to invalidate around exams
+    }
+    const QDate examDate(2026, 3, 16);
+    const QDate boosted = examDate.addDays(-boostDays.at(0).toInt());
+    const QDate afterExam = examDate.addDays(5);
+    const QDate doneDate = examDate.addDays(10);
+
+    planner.clearPlanCache();
+    planner.generateRange(boosted, doneDate);
+    const auto missesOf = [&planner](const QDate& date) {
+        const qint64 before = planner.planCacheStats().misses;
+        planner.generateDay(date);
+        return planner.planCacheStats().misses - before;
+    };
+    if (missesOf(boosted) != 0 || missesOf(doneDate) != 0) {
+        return false;
+    }
+
+    planner.setDone(doneDate, 0, true);
+    const bool doneInvalidatesDay = missesOf(doneDate) == 1 && missesOf(afterExam) == 0;
+    planner.setDone(doneDate, 0, false);
+
+    // Exam changes replan their boost window in place; other days stay cached.
+    const auto matchesFreshPlan = [&planner](const QDate& date) {
+        const QVector<Task> cached = planner.generateDay(date);
+        planner.clearPlanCache();
+        return samePlan(cached, planner.generateDay(date));
+    };
+    Exam exam;
+    exam.id = "test_exam_cache";
+    exam.subjectId = "ma";
+    exam.date = examDate;
+    planner.addOrUpdateExam(exam);
+    const bool examRefreshesWindow = missesOf(afterExam) == 0 && matchesFreshPlan(boosted);
+    planner.generateDay(boosted);
+    planner.removeExam(exam.id);
+    const bool removalRefreshesWindow = matchesFreshPlan(boosted);
+
+    return doneInvalidatesDay && examRefreshesWindow && removalRefreshesWindow;
+}
+
+bool testExamChangeEmitsPlanDiff(PlannerService& planner) {
+    const QDate examDate(2026, 5, 11);
+    const QDate first = examDate.addDays(-30);
+    planner.clearPlanCache();
+    const QList<QVector<Task>> before = planner.generateRange(first, examDate);
+
+    QList<DayPlanDiff> diffs;
+    int dataChanges = 0;
+    QObject receiver;
+    QObject::connect(&planner, &PlannerService::planChanged, &receiver,
+                     [&diffs](const QList<DayPlanDiff>& changed) { diffs += changed; });
+    QObject::connect(&planner, &PlannerService::dataChanged, &receiver, [&dataChanges]() { ++dataChanges; });
+
+    // Several boosted exams on the same day make the window's plans shift.
+    QStringList ids;
+    for (const Subject& subject : planner.subjects()) {
+        Exam exam;
+        exam.id = QStringLiteral("test_diff_%1").arg(subject.id);
+        exam.subjectId = subject.id;
+        exam.date = examDate;
+        planner.addOrUpdateExam(exam);
+        ids.append(exam.id);
+        if (ids.size() == 3) break;
+    }
+
+    // Applying the diffs to the old plans must give the new ones, and only boost
+    // window days may appear.
+    QSet<QDate> window;
+    for (const auto& day : planner.config().value("exam_boost_days").toArray()) {
+        window.insert(examDate.addDays(-day.toInt()));
+    }
+    QHash<QDate, QVector<Task>> patched;
+    for (int day = 0; day < before.size(); ++day) {
+        patched.insert(first.addDays(day), before.at(day));
+    }
+    bool consistent = dataChanges == ids.size();
+    for (const DayPlanDiff& diff : diffs) {
+        consistent = consistent && window.contains(diff.date) && patched.contains(diff.date);
+        QVector<Task>& plan = patched[diff.date];
+        for (const Task& task : diff.changed) {
+            plan[task.planIndex] = task;
+        }
+        plan.resize(plan.size() - diff.removed.size());
+        plan += diff.added;
+    }
+    planner.clearPlanCache();
+    for (int day = 0; day < before.size() && consistent; ++day) {
+        const QDate date = first.addDays(day);
+        consistent = samePlan(patched.value(date), planner.generateDay(date));
+    }
+
+    for (const QString& id : ids) {
+        planner.removeExam(id);
+    }
+    return consistent;
+}
+
+bool testExamsOutsideBoostWindowLeavePlanUnchanged(PlannerService& planner) {
+    const QDate date(2026, 2, 10);
+    QSet<int> boostDays;
+    for (const auto& day : planner.config().value("exam_boost_days").toArray()) {
+        boostDays.insert(day.toInt());
+    }
+    planner.clearPlanCache();
+    const QVector<Task> before = planner.generateDay(date);
+
+    QStringList ids;
+    for (int offset = -60; offset <= 60; ++offset) {
+        if (boostDays.contains(offset)) continue;
+        Exam exam;
+        exam.id = QStringLiteral("test_far_exam_%1").arg(offset);
+        exam.subjectId = "ma";
+        exam.date = date.addDays(offset);
+        planner.addOrUpdateExam(exam);
+        ids.append(exam.id);
+    }
+    planner.clearPlanCache();
+    const bool unchanged = samePlan(before, planner.generateDay(date));
+
+    for (const QString& id : ids) {
+        planner.removeExam(id);
+    }
+    return unchanged;
+}
+
+bool testPlannerConfigCompilesBreaksAndBoosts(PlannerService&) {
+    const PlannerConfig config = PlannerConfig::fromJson(QJsonObject{
+        {"daily_capacity_min", QJsonObject{{"0", 60}, {"6", -10}}},
+        {"breaks", QJsonArray{"2025-12-20..2026-01-04", "bogus", "2025-12-28..2026-01-06", "2025-10-27..2025-10-31"}},
+        {"exam_boost_days", QJsonArray{7, 1, 3}},
+        {"exam_boost_factors", QJsonArray{1.25, 1.1}},
+        {"slot_min", 50},
+        {"slot_max", 30},
+    });
+
+    const bool capacity = config.capacityFor(QDate(2025, 11, 3)) == 60  // Monday
+        && config.capacityFor(QDate(2025, 11, 9)) == 0                  // Sunday, clamped
+        && config.capacityFor(QDate()) == 0;
+    const bool breaks = config.breaks.size() == 2 && config.isBreak(QDate(2025, 10, 27))
+        && config.isBreak(QDate(2026, 1, 6)) && !config.isBreak(QDate(2026, 1, 7))
+        && !config.isBreak(QDate(2025, 12, 19)) && !config.isBreak(QDate(2025, 11, 1));
+    const bool boosts = config.examBoosts.size() == 2 && config.examBoosts.at(1).daysBefore == 1
+        && qFuzzyCompare(config.examBoosts.at(1).factor, 1.1);
+    const bool slots = config.slotMin == 20 && config.slotMax == 40 && config.maxSlots == 3;
+    return capacity && breaks && boosts && slots;
+}
+
 bool testComputePriorityForOverdueTask(PlannerService& planner) {
     Task task;
     task.date = QDate::currentDate().addDays(-1); // Yesterday
@@ -179,6 +362,11 @@ int main(int argc, char* argv[]) {
         {"Add and remove exam", testAddAndRemoveExam},
         {"Update existing exam", testUpdateExistingExam},
         {"Generate range returns correct number of days", testGenerateRangeReturnsCorrectNumberOfDays},
+        {"Parallel range matches generate day", testParallelRangeMatchesGenerateDay},
+        {"Planner config compiles breaks and boosts", testPlannerConfigCompilesBreaksAndBoosts},
+        {"Plan cache invalidates touched dates", testPlanCacheInvalidatesTouchedDates},
+        {"Exam change emits plan diff", testExamChangeEmitsPlanDiff},
+        {"Exams outside boost window leave plan unchanged", testExamsOutsideBoostWindowLeavePlanUnchanged},
         {"Compute priority for overdue task", testComputePriorityForOverdueTask},
         {"Compute priority for done task", testComputePriorityForDoneTask},
         {"Subjects loaded correctly", testSubjectsLoadedCorrectly},
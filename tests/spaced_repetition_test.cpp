@@ -1,9 +1,13 @@
+#include "core/DataFile.h"
 #include "core/SpacedRepetitionService.h"
 #include "core/Review.h"
 
 #include <QCoreApplication>
 #include <QDate>
 #include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QTemporaryDir>
 
 #include <iostream>
@@ -208,6 +212,57 @@ bool testEaseFactorModifierIsRespected(SpacedRepetitionService& service) {
     return true;
 }
 
+bool testReviewsMigrateBetweenFormats(SpacedRepetitionService&) {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+    const QString jsonPath = QDir(dir.path()).filePath(QStringLiteral("reviews.json"));
+    const QString cborPath = data_file::cborPath(jsonPath);
+
+    data_file::setFormat(DataFormat::Json);
+    {
+        SpacedRepetitionService writer(dir.path());
+        writer.addReview("ph", "Optik");
+        writer.addReview("ch", "Redox");
+    }
+    data_file::flushPending();
+    // Loading with the binary format selected converts the existing text file.
+    data_file::setFormat(DataFormat::Cbor);
+    SpacedRepetitionService binary(dir.path());
+    const bool converted = binary.reviews().size() == 2 && QFileInfo::exists(cborPath) && !QFileInfo::exists(jsonPath);
+    binary.addReview("bio", "Zellatmung");
+    data_file::flushPending();
+
+    data_file::setFormat(DataFormat::Json);
+    SpacedRepetitionService text(dir.path());
+    return converted && text.reviews().size() == 3 && text.reviews().last().topic == QStringLiteral("Zellatmung")
+        && QFileInfo::exists(jsonPath) && !QFileInfo::exists(cborPath);
+}
+
+bool testRapidSavesAreCoalesced(SpacedRepetitionService&) {
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        return false;
+    }
+    data_file::flushPending();
+    data_file::setFormat(DataFormat::Json);
+    const int delay = data_file::writeDelay();
+    data_file::setWriteDelay(60 * 1000);
+    SpacedRepetitionService service(dir.path());
+    for (int i = 0; i < 50; ++i) {
+        service.addReview("ma", QStringLiteral("Aufgabe %1").arg(i));
+    }
+    // Fifty saves, one pending document; reads already see it.
+    const bool coalesced = data_file::pendingCount() == 1 && SpacedRepetitionService(dir.path()).reviews().size() == 50;
+    data_file::flushPending();
+    data_file::setWriteDelay(delay);
+    const QString path = QDir(dir.path()).filePath(QStringLiteral("reviews.json"));
+    const std::optional<QJsonDocument> stored = data_file::read(path);
+    return coalesced && data_file::pendingCount() == 0 && stored
+        && stored->object().value(QStringLiteral("reviews")).toArray().size() == 50;
+}
+
 } // namespace
 
 int main(int argc, char* argv[]) {
@@ -236,6 +291,8 @@ int main(int argc, char* argv[]) {
         {"Reviews on date filters correctly", testReviewsOnDateFiltersCorrectly},
         {"Set initial interval changes interval", testSetInitialIntervalChangesInterval},
         {"Ease factor modifier is respected", testEaseFactorModifierIsRespected},
+        {"Reviews migrate between JSON and CBOR", testReviewsMigrateBetweenFormats},
+        {"Rapid saves are coalesced", testRapidSavesAreCoalesced},
     };
     
     bool allPassed = true;